@@ -3,10 +3,13 @@
 #include <support/call_builder.h>
 #include <support/call_wrapper.h>
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/Value.h>
 
-#include <map>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace coverage {
 
@@ -16,6 +19,20 @@ enum branch_visits { None = 0x0, True = 0x1, False = 0x2, All = 0x3 };
 
 } // namespace detail
 
+/**
+ * Call wrapper that records which directions of each conditional branch in the
+ * implementation have been taken.
+ *
+ * Coverage is recorded by inline instrumentation rather than callbacks: each
+ * conditional branch is assigned an ID, and before the branch executes, the
+ * instrumented code ORs a bit for the direction taken into a byte array mapped
+ * into the JIT-compiled module. Optionally (see enable_hit_counts()), a second
+ * array of saturating 8-bit hit counters per branch edge can be maintained as
+ * well.
+ *
+ * The arrays are heap-allocated so that their addresses stay fixed when the
+ * wrapper is moved.
+ */
 class wrapper : public support::call_wrapper {
 public:
   template <typename... Args>
@@ -45,31 +62,27 @@ public:
   double coverage() const;
 
   /**
-   * Handler to be called back into from instrumented code - calls to it should
-   * never be made outside of generated / JIT-compiled LLVM code.
+   * Also record the number of times each branch edge is taken, using counters
+   * that saturate at 255. This must be called before the first call is made.
    */
-  void handle_branch_event(int id, bool value);
+  void enable_hit_counts();
 
   /**
-   * Add additional instrumentation code to the function that allows it to be
-   * interrupted when an external flag is changed.
-   *
-   * The primary motivation for this feature is to allow for timeouts to be
-   * enforced by a timer on another thread.
-   *
-   * To implement the interrupt signal:
-   *  - Add an additional exit block to the function that returns a dummy (zero)
-   *    constant of the appropriate type.
-   *  - Create an externally-mapped pointer-to-bool using the supplied address.
-   *  - For every basic block, create an auxiliary block.
-   *  - Move the original terminator into the auxiliary block.
-   *  - At the end of the original block, test the external bool pointer and
-   *    make a conditional branch to either the exit block or the auxiliary one.
+   * The raw coverage bitmap: one byte per conditional branch, with bits set
+   * according to detail::branch_visits for the directions that have been
+   * taken.
+   */
+  llvm::ArrayRef<uint8_t> bitmap() const;
+
+  /**
+   * Hit counters for each branch edge, if enabled: the counter for the true
+   * edge of branch i is at index 2i, and the false edge at 2i + 1. Empty if hit
+   * counting has not been enabled.
    */
-  void enable_interrupts(bool*);
+  llvm::ArrayRef<uint8_t> hit_counts() const;
 
   /**
-   * Reset the running observations of branches visited.
+   * Reset the running observations of branches visited (and hit counts).
    *
    * This allows for multiple experiments to be run without the costly step of
    * re-instrumenting the entire function.
@@ -79,8 +92,12 @@ public:
 private:
   void instrument();
 
-  std::map<llvm::BranchInst*, int> branch_ids_ = {};
-  std::map<int, detail::branch_visits> visits_ = {};
+  // Only valid until the wrapper is compiled; the index of each branch is its
+  // ID in the coverage arrays.
+  std::vector<llvm::BranchInst*> branches_ = {};
+
+  std::unique_ptr<uint8_t[]> bitmap_ = nullptr;
+  std::unique_ptr<uint8_t[]> hit_counts_ = nullptr;
 };
 
 } // namespace coverage
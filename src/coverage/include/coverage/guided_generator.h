@@ -0,0 +1,95 @@
+#pragma once
+
+#include <coverage/coverage.h>
+
+#include <support/argument_generator.h>
+#include <support/call_builder.h>
+
+#include <props/props.h>
+
+#include <llvm/IR/Module.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace coverage {
+
+/**
+ * Argument generator that uses coverage feedback from a reference
+ * implementation to find inputs that exercise more of its behaviour than
+ * uniformly sampled ones would.
+ *
+ * The generator keeps a corpus of inputs that have been found to be
+ * interesting. Each new input is either sampled uniformly (occasionally, or if
+ * the corpus is empty), or produced by mutating the scalars and array elements
+ * of an input from the corpus. Every generated input is run through an
+ * instrumented copy of the reference implementation, and added to the corpus
+ * if it reaches a branch direction, or a bucket of edge hit counts, that no
+ * previous input has.
+ *
+ * Mutated values stay within the bounds of the underlying uniform generator so
+ * that integer parameters remain safe to use as array indexes.
+ *
+ * Copies of a generator share the instrumented implementation, but have their
+ * own corpus and coverage history. Because the implementation is JIT-compiled,
+ * generators should only be used on the thread that created them.
+ */
+class guided_generator {
+public:
+  guided_generator(
+      props::signature sig, llvm::Module const& mod, std::string const& name);
+
+  guided_generator(
+      props::signature sig, llvm::Module const& mod, std::string const& name,
+      support::uniform_generator base);
+
+  void seed(std::random_device::result_type);
+  void gen_args(support::call_builder&);
+
+  /**
+   * The inputs found so far that increased coverage, in the order they were
+   * found.
+   */
+  std::vector<support::call_builder> const& corpus() const;
+
+  /**
+   * Proportion of branch conditions in the implementation that have been
+   * covered by any generated input.
+   */
+  double coverage() const;
+
+private:
+  void mutate(support::call_builder const& parent, support::call_builder& out);
+
+  int64_t mutate_int(int64_t val);
+  float mutate_float(float val);
+  char mutate_char(char val);
+
+  template <typename T>
+  T mutate_value(T val);
+
+  template <typename T>
+  void mutate_array(std::vector<T>& arr);
+
+  bool coin(double p);
+
+  /**
+   * Run the input through the instrumented implementation, and add it to the
+   * corpus if it produces new coverage.
+   */
+  void observe(support::call_builder const& input);
+
+  std::shared_ptr<wrapper> wrapper_;
+  support::uniform_generator base_;
+  std::default_random_engine engine_;
+
+  std::vector<support::call_builder> corpus_;
+
+  std::vector<uint8_t> seen_branches_;
+  std::vector<uint8_t> seen_hits_;
+};
+
+} // namespace coverage
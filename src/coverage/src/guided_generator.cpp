@@ -0,0 +1,270 @@
+#include <coverage/guided_generator.h>
+
+#include <support/assert.h>
+#include <support/random.h>
+
+#include <algorithm>
+#include <bitset>
+#include <limits>
+
+using namespace support;
+
+namespace coverage {
+
+namespace {
+
+// Probability of sampling a completely fresh input rather than mutating one
+// from the corpus.
+constexpr double fresh_probability = 0.1;
+
+// Probability of mutating several parameters at once rather than just one.
+constexpr double havoc_probability = 0.25;
+
+/**
+ * Hit counts are compared in logarithmic buckets (as in AFL), so that running
+ * a loop a few more times doesn't count as new behaviour, but running it an
+ * order of magnitude more does.
+ */
+uint8_t hit_bucket(uint8_t count)
+{
+  if (count == 0) {
+    return 0;
+  } else if (count <= 3) {
+    return uint8_t(1) << (count - 1);
+  } else if (count <= 7) {
+    return 1 << 3;
+  } else if (count <= 15) {
+    return 1 << 4;
+  } else if (count <= 31) {
+    return 1 << 5;
+  } else if (count <= 127) {
+    return 1 << 6;
+  } else {
+    return 1 << 7;
+  }
+}
+
+/**
+ * Merge new bits into a record of bits seen, returning true if any of them
+ * were not already set.
+ */
+template <typename Bits, typename F>
+bool merge_novel(Bits const& bits, std::vector<uint8_t>& seen, F&& transform)
+{
+  auto novel = false;
+
+  for (auto i = 0u; i < bits.size(); ++i) {
+    auto val = transform(bits[i]);
+
+    if (val & ~seen[i]) {
+      novel = true;
+      seen[i] |= val;
+    }
+  }
+
+  return novel;
+}
+
+} // namespace
+
+guided_generator::guided_generator(
+    props::signature sig, llvm::Module const& mod, std::string const& name)
+    : guided_generator(sig, mod, name, uniform_generator())
+{
+}
+
+guided_generator::guided_generator(
+    props::signature sig, llvm::Module const& mod, std::string const& name,
+    uniform_generator base)
+    : wrapper_(std::make_shared<wrapper>(sig, mod, name))
+    , base_(base)
+    , engine_(random_seed())
+    , corpus_ {}
+    , seen_branches_ {}
+    , seen_hits_ {}
+{
+  wrapper_->enable_hit_counts();
+
+  seen_branches_.resize(wrapper_->bitmap().size(), 0);
+  seen_hits_.resize(wrapper_->hit_counts().size(), 0);
+}
+
+void guided_generator::seed(std::random_device::result_type seed)
+{
+  base_.seed(seed);
+  engine_.seed(seed);
+}
+
+void guided_generator::gen_args(call_builder& build)
+{
+  if (corpus_.empty() || coin(fresh_probability)) {
+    base_.gen_args(build);
+  } else {
+    auto idx = std::uniform_int_distribution<size_t>(0, corpus_.size() - 1)(
+        engine_);
+    mutate(corpus_[idx], build);
+  }
+
+  observe(build);
+}
+
+std::vector<call_builder> const& guided_generator::corpus() const
+{
+  return corpus_;
+}
+
+double guided_generator::coverage() const
+{
+  auto covered = size_t {0};
+  for (auto bits : seen_branches_) {
+    covered += std::bitset<8>(bits).count();
+  }
+
+  if (seen_branches_.empty()) {
+    return 1.0;
+  }
+
+  return static_cast<double>(covered) / (2.0 * seen_branches_.size());
+}
+
+void guided_generator::mutate(call_builder const& parent, call_builder& out)
+{
+  using props::base_type;
+
+  auto const& params = out.signature().parameters;
+
+  auto target = std::uniform_int_distribution<size_t>(0, params.size() - 1)(
+      engine_);
+  auto havoc = coin(havoc_probability);
+
+  for (auto i = 0u; i < params.size(); ++i) {
+    auto const& param = params[i];
+    auto change = (i == target) || (havoc && coin(0.5));
+
+    auto copy_scalar = [&](auto val) {
+      out.add(change ? mutate_value(val) : val);
+    };
+
+    auto copy_array = [&](auto vals) {
+      if (change) {
+        mutate_array(vals);
+      }
+      out.add(std::move(vals));
+    };
+
+    if (param.pointer_depth == 0) {
+      if (param.type == base_type::integer) {
+        copy_scalar(parent.get<int64_t>(i));
+      } else if (param.type == base_type::floating) {
+        copy_scalar(parent.get<float>(i));
+      } else if (param.type == base_type::character) {
+        copy_scalar(parent.get<char>(i));
+      } else {
+        invalid_state();
+      }
+    } else {
+      if (param.type == base_type::integer) {
+        copy_array(parent.get<std::vector<int64_t>>(i));
+      } else if (param.type == base_type::floating) {
+        copy_array(parent.get<std::vector<float>>(i));
+      } else if (param.type == base_type::character) {
+        copy_array(parent.get<std::vector<char>>(i));
+      } else {
+        invalid_state();
+      }
+    }
+  }
+}
+
+template <typename T>
+T guided_generator::mutate_value(T val)
+{
+  if constexpr (std::is_same_v<T, int64_t>) {
+    return mutate_int(val);
+  } else if constexpr (std::is_same_v<T, float>) {
+    return mutate_float(val);
+  } else {
+    return mutate_char(val);
+  }
+}
+
+template <typename T>
+void guided_generator::mutate_array(std::vector<T>& arr)
+{
+  if (arr.empty()) {
+    return;
+  }
+
+  auto index = std::uniform_int_distribution<size_t>(0, arr.size() - 1);
+  auto n = std::uniform_int_distribution<int>(1, 4)(engine_);
+
+  for (auto i = 0; i < n; ++i) {
+    auto& elt = arr[index(engine_)];
+    elt = mutate_value(elt);
+  }
+}
+
+int64_t guided_generator::mutate_int(int64_t val)
+{
+  auto lo = int64_t {base_.int_min};
+  auto hi = int64_t {base_.int_max};
+
+  switch (std::uniform_int_distribution<int>(0, 2)(engine_)) {
+  case 0:
+    return std::uniform_int_distribution<int64_t>(lo, hi)(engine_);
+  case 1:
+    return std::clamp(val + 1, lo, hi);
+  default:
+    return std::clamp(val - 1, lo, hi);
+  }
+}
+
+float guided_generator::mutate_float(float val)
+{
+  auto lo = base_.float_min;
+  auto hi = base_.float_max;
+
+  switch (std::uniform_int_distribution<int>(0, 2)(engine_)) {
+  case 0:
+    return std::uniform_real_distribution<float>(lo, hi)(engine_);
+  case 1: {
+    auto delta = std::normal_distribution<float>(0, (hi - lo) / 20)(engine_);
+    return std::clamp(val + delta, lo, hi);
+  }
+  default:
+    return std::clamp(-val, lo, hi);
+  }
+}
+
+char guided_generator::mutate_char(char)
+{
+  return static_cast<char>(std::uniform_int_distribution<int>(
+      std::numeric_limits<char>::min(), std::numeric_limits<char>::max())(
+      engine_));
+}
+
+bool guided_generator::coin(double p)
+{
+  return std::bernoulli_distribution(p)(engine_);
+}
+
+void guided_generator::observe(call_builder const& input)
+{
+  // The call can modify array data, so it needs its own copy of the input.
+  auto run = input;
+
+  wrapper_->reset();
+  wrapper_->call(run);
+
+  auto identity = [](auto b) { return b; };
+
+  auto new_branches
+      = merge_novel(wrapper_->bitmap(), seen_branches_, identity);
+  auto new_hits = merge_novel(wrapper_->hit_counts(), seen_hits_, hit_bucket);
+
+  if (new_branches || new_hits) {
+    corpus_.push_back(input);
+  }
+}
+
+} // namespace coverage
@@ -3,9 +3,13 @@
 #include <coverage/coverage.h>
 
 #include <support/argument_generator.h>
+#include <support/llvm_cloning.h>
 #include <support/load_module.h>
 #include <support/options.h>
+#include <support/ordered_writer.h>
+#include <support/thread_context.h>
 #include <support/timeout.h>
+#include <support/work_queue.h>
 
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
@@ -14,7 +18,9 @@
 
 #include <fmt/format.h>
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
 
 using namespace support;
 using namespace llvm;
@@ -81,9 +87,65 @@ coverage::wrapper get_wrapper(Module& mod, std::string const& name)
   return coverage::wrapper(mod, name);
 }
 
+std::string
+run_entry(Module& mod, uniform_generator& gen, manifest_entry const& entry)
+{
+  using namespace fmt::literals;
+
+  auto const& [func, gr, impl] = entry;
+  auto wrapper = get_wrapper(mod, impl);
+
+  auto out = std::string {};
+
+  for (auto rep = 0; rep < Reps; ++rep) {
+    if (Seed.getNumOccurrences() > 0) {
+      gen.seed(Seed + rep);
+    }
+
+    auto print_row = [&](auto inputs) {
+      if (!Single || inputs == NumInputs) {
+        out += fmt::format(
+            "{name},{group},{iter},{cover},{total}\n",
+            "name"_a = wrapper.name(), "group"_a = gr, "iter"_a = inputs,
+            "cover"_a = wrapper.covered_conditions(),
+            "total"_a = wrapper.total_conditions());
+      }
+    };
+
+    auto build = wrapper.get_builder();
+    auto run_one = [&] {
+      build.reset();
+      gen.gen_args(build);
+      wrapper.call(build);
+    };
+
+    if (Independent) {
+      for (auto i = 1; i <= NumInputs; ++i) {
+        wrapper.reset();
+
+        for (auto j = 0; j < i; ++j) {
+          run_one();
+        }
+
+        print_row(i);
+      }
+    } else {
+      // Branch visits accumulate across calls, so each point on the curve
+      // only needs one more input to be run.
+      wrapper.reset();
+
+      for (auto i = 1; i <= NumInputs; ++i) {
+        run_one();
+        print_row(i);
+      }
+    }
+  }
+
+  return out;
+}
+
 int main(int argc, char** argv)
 try {
-  using namespace fmt::literals;
   using namespace std::chrono_literals;
 
   hide_llvm_options();
@@ -105,37 +167,34 @@ try {
         "{},{},{},{},{}\n", "name", "group", "inputs", "covered", "total");
   }
 
-  auto gen = uniform_generator();
-
   auto input = get_effective_input();
 
-  auto idx = 0;
-  for (auto const& [func, gr, impl] : input) {
-    if (Progress) {
-      fmt::print(stderr, "[{}/{}]\r", ++idx, input.size());
-    }
+  auto out = ordered_writer(stdout);
+  auto done = std::atomic<size_t> {0};
 
-    auto wrapper = get_wrapper(*mod, impl);
+  // Workers each need their own copy of the module in their thread's context;
+  // the copies are made one at a time so that the original is only ever read
+  // by a single thread.
+  auto mod_mutex = std::mutex {};
 
-    for (auto rep = 0; rep < Reps; ++rep) {
-      for (auto i = 0; i < NumInputs; ++i) {
-        wrapper.reset();
+  auto make_worker = [&] {
+    auto local_mod = [&] {
+      auto lock = std::lock_guard {mod_mutex};
+      return copy_module_to(thread_context::get(), *mod);
+    }();
 
-        for (auto j = 0; j < i; ++j) {
-          auto build = wrapper.get_builder();
-          gen.gen_args(build);
-          wrapper.call(build);
-        }
+    auto gen = uniform_generator();
 
-        fmt::print(
-            "{name},{group},{iter},{cover},{total}\n",
-            "name"_a = wrapper.name(), "group"_a = gr, "iter"_a = i + 1,
-            "cover"_a = wrapper.covered_conditions(),
-            "total"_a = wrapper.total_conditions());
+    return [&, local_mod = std::move(local_mod), gen](size_t idx) mutable {
+      out.write(idx, run_entry(*local_mod, gen, input[idx]));
+
+      if (Progress) {
+        fmt::print(stderr, "[{}/{}]\r", ++done, input.size());
       }
-    }
-  }
+    };
+  };
 
+  work_queue(Jobs).run(input.size(), make_worker);
 } catch (std::runtime_error& e) {
   llvm::errs() << "Error creating coverage JIT wrapper:  ";
   llvm::errs() << e.what() << '\n';
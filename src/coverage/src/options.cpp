@@ -41,3 +41,24 @@ cl::alias SingleA("s", cl::desc("Alias for single"), cl::aliasopt(Single));
 
 cl::opt<bool>
     Progress("progress", cl::desc("Print progress to stderr"), cl::init(false));
+
+cl::opt<bool> Independent(
+    "independent",
+    cl::desc("Generate a fresh set of inputs for every point on the coverage "
+             "curve rather than extending it one input at a time (quadratic "
+             "in the number of inputs)"),
+    cl::init(false));
+
+cl::opt<unsigned> Seed(
+    "seed",
+    cl::desc("Seed for input generation, so that coverage curves are "
+             "reproducible (each repetition uses seed + rep)"),
+    cl::value_desc("seed"));
+
+cl::opt<unsigned> Jobs(
+    "jobs",
+    cl::desc("Number of manifest entries to process in parallel (0 to use "
+             "every hardware thread)"),
+    cl::value_desc("n"), cl::init(0));
+
+cl::alias JobsA("j", cl::desc("Alias for jobs"), cl::aliasopt(Jobs));
@@ -10,3 +10,6 @@ extern llvm::cl::opt<int> Reps;
 extern llvm::cl::opt<bool> Header;
 extern llvm::cl::opt<bool> Single;
 extern llvm::cl::opt<bool> Progress;
+extern llvm::cl::opt<bool> Independent;
+extern llvm::cl::opt<unsigned> Seed;
+extern llvm::cl::opt<unsigned> Jobs;
@@ -1,184 +1,138 @@
 #include <coverage/coverage.h>
 
+#include <support/assert.h>
 #include <support/thread_context.h>
 
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/IRBuilder.h>
-#include <llvm/IR/InstVisitor.h>
 
+#include <algorithm>
+#include <bitset>
 #include <numeric>
 
+namespace coverage {
+
 namespace {
 
-void handle_branch_event_trampoline(int id, bool val, char* inst)
+llvm::GlobalVariable*
+map_byte_array(llvm::Module& mod, size_t size, std::string const& name)
 {
-  auto wrapper = reinterpret_cast<coverage::wrapper*>(inst);
-  wrapper->handle_branch_event(id, val);
-}
-
-class instrument_visitor : public llvm::InstVisitor<instrument_visitor> {
-public:
-  instrument_visitor(
-      std::map<llvm::BranchInst*, int>& ids, llvm::Value* inst,
-      llvm::Function* tram)
-      : next_id_(0)
-      , ids_(ids)
-      , instance_ptr_(inst)
-      , trampoline_(tram)
-  {
-  }
-
-  void visitBranchInst(llvm::BranchInst& inst)
-  {
-    auto build = llvm::IRBuilder<>(&inst);
-
-    if (inst.isConditional()) {
-      build.CreateCall(
-          trampoline_,
-          {build.getInt64(next_id_), inst.getCondition(), instance_ptr_});
-
-      ids_[&inst] = next_id_;
-      ++next_id_;
-    }
-  }
-
-private:
-  int next_id_;
-  std::map<llvm::BranchInst*, int>& ids_;
+  auto& ctx = support::thread_context::get();
+  auto arr_t = llvm::ArrayType::get(llvm::IntegerType::get(ctx, 8), size);
 
-  llvm::Value* instance_ptr_;
-  llvm::Function* trampoline_;
-};
+  return new llvm::GlobalVariable(
+      mod, arr_t, false, llvm::GlobalValue::ExternalLinkage, nullptr, name);
+}
 
 } // namespace
 
-namespace coverage {
-
 void wrapper::instrument()
 {
-  auto& ctx = support::thread_context::get();
   auto mod = implementation()->getParent();
 
-  auto i8_t = llvm::IntegerType::get(ctx, 8);
-  auto p_i8_t = llvm::PointerType::getUnqual(i8_t);
+  for (auto& bb : *implementation()) {
+    if (auto br = llvm::dyn_cast<llvm::BranchInst>(bb.getTerminator())) {
+      if (br->isConditional()) {
+        branches_.push_back(br);
+      }
+    }
+  }
 
-  // Add pointer back to this instance of the wrapper class so that we can call
-  // the trampoline properly.
-  auto instance_ptr = new llvm::GlobalVariable(
-      *mod, i8_t, true, llvm::GlobalValue::ExternalLinkage, nullptr,
-      "instance");
-  engine()->addGlobalMapping(instance_ptr, (void*)this);
+  bitmap_ = std::make_unique<uint8_t[]>(branches_.size());
 
-  // Create another global mapping for the trampoline function. The visitor then
-  // receives this external function as its callback to insert.
-  auto i64_t = llvm::IntegerType::get(ctx, 64);
-  auto bool_t = llvm::IntegerType::get(ctx, 1);
-  auto void_t = llvm::Type::getVoidTy(ctx);
-  auto trampoline_t
-      = llvm::FunctionType::get(void_t, {i64_t, bool_t, p_i8_t}, false);
+  if (!branches_.empty()) {
+    auto bitmap = map_byte_array(*mod, branches_.size(), "coverage.bitmap");
+    add_global_mapping(bitmap, bitmap_.get());
 
-  auto func = llvm::Function::Create(
-      trampoline_t, llvm::GlobalValue::ExternalLinkage, "trampoline", *mod);
-  engine()->addGlobalMapping(func, (void*)handle_branch_event_trampoline);
+    // bitmap[id] |= (cond ? True : False)
+    for (auto i = 0u; i < branches_.size(); ++i) {
+      auto br = branches_[i];
+      auto build = llvm::IRBuilder<>(br);
 
-  instrument_visitor(branch_ids_, instance_ptr, func).visit(implementation());
+      auto bit = build.CreateSelect(
+          br->getCondition(), build.getInt8(detail::branch_visits::True),
+          build.getInt8(detail::branch_visits::False));
+
+      auto ptr = build.CreateConstInBoundsGEP2_64(
+          bitmap->getValueType(), bitmap, 0, i);
+      auto old = build.CreateLoad(build.getInt8Ty(), ptr);
+      build.CreateStore(build.CreateOr(old, bit), ptr);
+    }
+  }
 
   reset();
 }
 
-void wrapper::enable_interrupts(bool* signal_ptr)
+void wrapper::enable_hit_counts()
 {
-  auto& ctx = support::thread_context::get();
-  auto mod = implementation()->getParent();
+  assumes(!hit_counts_, "Hit counting is already enabled");
+  assumes(
+      !compiled(),
+      "Hit counting must be enabled before the first call is made, as the "
+      "module has already been compiled");
 
-  auto bool_t = llvm::IntegerType::get(ctx, 1);
-
-  // Add the pointer mapping for the termination signal
-  auto signal = new llvm::GlobalVariable(
-      *mod, bool_t, true, llvm::GlobalValue::ExternalLinkage, nullptr,
-      "signal");
-  engine()->addGlobalMapping(signal, (void*)signal_ptr);
+  auto mod = implementation()->getParent();
 
-  auto bb_work = std::vector<llvm::BasicBlock*> {};
-  for (auto& bb : *implementation()) {
-    bb_work.push_back(&bb);
-  }
+  auto size = branches_.size() * 2;
+  hit_counts_ = std::make_unique<uint8_t[]>(size);
 
-  // Create the dummy-exit basic block for interrupted executions
-  auto exit_block
-      = llvm::BasicBlock::Create(ctx, "interrupt-exit", implementation());
-  auto build = llvm::IRBuilder<>(exit_block);
-
-  // Return a null constant from the exit block - the actual value should never
-  // be used.
-  auto ret_ty = implementation()->getFunctionType()->getReturnType();
-  if (ret_ty->isVoidTy()) {
-    build.CreateRetVoid();
-  } else {
-    auto ret_val = llvm::Constant::getNullValue(ret_ty);
-    build.CreateRet(ret_val);
+  if (branches_.empty()) {
+    return;
   }
 
-  // Create the new branching logic (the load needs to be volatile to prevent
-  // the optimizer from hoisting it). PHI nodes are updated to make sure that
-  // they come from the auxiliary block.
-  auto phi_map = std::map<llvm::BasicBlock*, llvm::BasicBlock*> {};
-  for (auto bb : bb_work) {
-    auto aux_bb = llvm::BasicBlock::Create(
-        ctx, bb->getName() + ".aux", implementation());
+  auto counts = map_byte_array(*mod, size, "coverage.hits");
+  add_global_mapping(counts, hit_counts_.get());
 
-    auto term = bb->getTerminator();
-    term->moveBefore(*aux_bb, aux_bb->begin());
+  // counts[2 * id + !cond] = min(counts[...] + 1, 255)
+  for (auto i = 0u; i < branches_.size(); ++i) {
+    auto br = branches_[i];
+    auto build = llvm::IRBuilder<>(br);
 
-    build.SetInsertPoint(bb, bb->end());
-    auto load = build.CreateLoad(signal);
-    load->setVolatile(true);
+    auto idx = build.CreateSelect(
+        br->getCondition(), build.getInt64(2 * i), build.getInt64(2 * i + 1));
 
-    build.CreateCondBr(load, exit_block, aux_bb);
-
-    phi_map[bb] = aux_bb;
+    auto ptr = build.CreateInBoundsGEP(
+        counts->getValueType(), counts, {build.getInt64(0), idx});
+    auto old = build.CreateLoad(build.getInt8Ty(), ptr);
+    auto saturated = build.CreateICmpEQ(old, build.getInt8(255));
+    auto next = build.CreateSelect(
+        saturated, old, build.CreateAdd(old, build.getInt8(1)));
+    build.CreateStore(next, ptr);
   }
+}
 
-  for (auto& bb : *implementation()) {
-    for (auto [old, aux] : phi_map) {
-      bb.replacePhiUsesWith(old, aux);
-    }
-  }
+llvm::ArrayRef<uint8_t> wrapper::bitmap() const
+{
+  return {bitmap_.get(), branches_.size()};
 }
 
-void wrapper::handle_branch_event(int id, bool value)
+llvm::ArrayRef<uint8_t> wrapper::hit_counts() const
 {
-  visits_[id] = detail::branch_visits(
-      visits_[id]
-      | (value ? detail::branch_visits::True : detail::branch_visits::False));
+  if (!hit_counts_) {
+    return {};
+  }
+
+  return {hit_counts_.get(), branches_.size() * 2};
 }
 
 void wrapper::reset()
 {
-  for (auto [branch, id] : branch_ids_) {
-    visits_[id] = detail::branch_visits::None;
+  std::fill_n(bitmap_.get(), branches_.size(), 0);
+
+  if (hit_counts_) {
+    std::fill_n(hit_counts_.get(), branches_.size() * 2, 0);
   }
 }
 
-size_t wrapper::total_conditions() const { return branch_ids_.size() * 2; }
+size_t wrapper::total_conditions() const { return branches_.size() * 2; }
 
 size_t wrapper::covered_conditions() const
 {
+  auto map = bitmap();
   return std::accumulate(
-      branch_ids_.begin(), branch_ids_.end(), 0, [this](auto acc, auto p) {
-        auto val = visits_.at(p.second);
-
-        if (val == detail::branch_visits::None) {
-          return acc;
-        } else if (
-            val == detail::branch_visits::True
-            || val == detail::branch_visits::False) {
-          return acc + 1;
-        } else {
-          return acc + 2;
-        }
-      });
+      map.begin(), map.end(), size_t {0},
+      [](auto acc, auto v) { return acc + std::bitset<8>(v).count(); });
 }
 
 double wrapper::coverage() const
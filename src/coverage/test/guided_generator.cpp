@@ -0,0 +1,147 @@
+#include <coverage/guided_generator.h>
+
+#include <props/props.h>
+
+#include <support/argument_generator.h>
+#include <support/call_wrapper.h>
+#include <support/load_module.h>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+using namespace props::literals;
+
+static_assert(
+    support::detail::is_generator<coverage::guided_generator>::value,
+    "Guided generator must be usable as an argument generator");
+
+auto nested = R"#(
+define i64 @nested(i64 %x, i64 %y, i64 %z) {
+  %c0 = icmp eq i64 %x, 3
+  br i1 %c0, label %1, label %4
+
+1:
+  %c1 = icmp eq i64 %y, -2
+  br i1 %c1, label %2, label %4
+
+2:
+  %c2 = icmp eq i64 %z, 17
+  br i1 %c2, label %3, label %4
+
+3:
+  ret i64 1
+
+4:
+  ret i64 0
+}
+)#";
+
+auto sum_pos = R"#(
+define i64 @sum_pos(i64 %n, float* %xs, i8 %c) {
+  br label %1
+
+1:
+  %i = phi i64 [ 0, %0 ], [ %i.next, %4 ]
+  %acc = phi i64 [ 0, %0 ], [ %acc.next, %4 ]
+  %cont = icmp slt i64 %i, %n
+  br i1 %cont, label %2, label %5
+
+2:
+  %ptr = getelementptr inbounds float, float* %xs, i64 %i
+  %x = load float, float* %ptr, align 4
+  %pos = fcmp ogt float %x, 0.000000e+00
+  br i1 %pos, label %3, label %4
+
+3:
+  %inc = add nsw i64 %acc, 1
+  br label %4
+
+4:
+  %acc.next = phi i64 [ %inc, %3 ], [ %acc, %2 ]
+  %i.next = add nsw i64 %i, 1
+  br label %1
+
+5:
+  ret i64 %acc
+}
+)#";
+
+TEST_CASE("Guided generators produce complete argument packs")
+{
+  PARSE_TEST_MODULE(mod, sum_pos);
+
+  auto sig = "int sum_pos(int n, float *xs, char c)"_sig;
+  auto gen = coverage::guided_generator(sig, *mod, "sum_pos");
+  gen.seed(0);
+
+  auto ref = support::call_wrapper(sig, *mod, "sum_pos");
+
+  for (auto i = 0; i < 100; ++i) {
+    auto build = ref.get_builder();
+    gen.gen_args(build);
+
+    REQUIRE(build.ready());
+
+    auto n = build.get<int64_t>(0);
+    auto xs = build.get<std::vector<float>>(1);
+
+    REQUIRE(n >= -4);
+    REQUIRE(n < static_cast<int64_t>(xs.size()));
+
+    REQUIRE(std::all_of(xs.begin(), xs.end(), [](auto x) {
+      return x >= -5.0f && x <= 5.0f;
+    }));
+  }
+
+  REQUIRE(!gen.corpus().empty());
+  REQUIRE(gen.corpus().size() < 100);
+  REQUIRE(gen.coverage() == 1.0);
+}
+
+TEST_CASE("Guided generators reach nested branches")
+{
+  PARSE_TEST_MODULE(mod, nested);
+
+  auto sig = "int nested(int x, int y, int z)"_sig;
+  auto gen = coverage::guided_generator(sig, *mod, "nested");
+  gen.seed(0);
+
+  auto ref = support::call_wrapper(sig, *mod, "nested");
+
+  // Sampling uniformly, each input has roughly a 1 in 50,000 chance of taking
+  // the innermost branch.
+  auto found = false;
+  for (auto i = 0; i < 5000 && !found; ++i) {
+    auto build = ref.get_builder();
+    gen.gen_args(build);
+
+    found = (ref.call(build) == 1);
+  }
+
+  REQUIRE(found);
+  REQUIRE(gen.coverage() == 1.0);
+}
+
+TEST_CASE("Copies of guided generators are independent")
+{
+  PARSE_TEST_MODULE(mod, nested);
+
+  auto sig = "int nested(int x, int y, int z)"_sig;
+  auto gen = coverage::guided_generator(sig, *mod, "nested");
+  gen.seed(0);
+
+  auto build = support::call_builder(sig);
+  gen.gen_args(build);
+
+  auto copy = gen;
+  REQUIRE(copy.corpus().size() == gen.corpus().size());
+
+  for (auto i = 0; i < 100; ++i) {
+    auto b = support::call_builder(sig);
+    copy.gen_args(b);
+  }
+
+  REQUIRE(gen.corpus().size() == 1);
+  REQUIRE(copy.corpus().size() >= gen.corpus().size());
+}
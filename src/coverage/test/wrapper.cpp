@@ -6,6 +6,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <numeric>
 #include <random>
 
 using namespace props::literals;
@@ -168,3 +170,60 @@ TEST_CASE("Coverage is monotonic")
     REQUIRE(cov <= wrap.coverage());
   }
 }
+
+TEST_CASE("Coverage survives moving the wrapper")
+{
+  PARSE_TEST_MODULE(mod, count_negs);
+
+  auto sig = "int count_negs(int n, float *xs)"_sig;
+
+  auto first = coverage::wrapper(sig, *mod, "count_negs");
+  auto wrap = std::move(first);
+
+  auto b = support::call_builder(sig, 2ll, std::vector<float> {-1, 1});
+
+  REQUIRE(wrap.call(b) == 1);
+  REQUIRE(wrap.coverage() == 1.0);
+  REQUIRE(wrap.bitmap().size() == 2);
+}
+
+TEST_CASE("Can count branch edge hits")
+{
+  PARSE_TEST_MODULE(mod, count_negs);
+
+  auto wrap = coverage::wrapper(
+      "int count_negs(int n, float *xs)"_sig, *mod, "count_negs");
+  REQUIRE(wrap.hit_counts().empty());
+
+  wrap.enable_hit_counts();
+  REQUIRE(wrap.hit_counts().size() == 4);
+
+  auto b = wrap.get_builder();
+  b.add(3ll, std::vector<float> {-1, 1, -2});
+  REQUIRE(wrap.call(b) == 2);
+
+  auto hits = wrap.hit_counts();
+  auto total = std::accumulate(hits.begin(), hits.end(), 0);
+
+  // The loop condition is evaluated 4 times and the sign test 3 times
+  REQUIRE(total == 7);
+
+  SECTION("Counters saturate")
+  {
+    auto big = wrap.get_builder();
+    big.add(1000ll, std::vector<float>(1000, 1.0f));
+    wrap.call(big);
+
+    auto max = *std::max_element(
+        wrap.hit_counts().begin(), wrap.hit_counts().end());
+    REQUIRE(max == 255);
+  }
+
+  SECTION("Resets clear counters")
+  {
+    wrap.reset();
+    auto cleared = wrap.hit_counts();
+    REQUIRE(std::all_of(
+        cleared.begin(), cleared.end(), [](auto c) { return c == 0; }));
+  }
+}
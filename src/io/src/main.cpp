@@ -6,6 +6,7 @@
 #include <support/bit_cast.h>
 #include <support/call_wrapper.h>
 #include <support/dynamic_library.h>
+#include <support/example_file.h>
 #include <support/llvm_format.h>
 #include <support/options.h>
 #include <support/thread_context.h>
@@ -82,24 +83,49 @@ try {
   auto mod = Module("perf_internal", thread_context::get());
   auto ref = call_wrapper(property_set.type_signature, mod, fn_name, lib);
 
-  auto gen = uniform_generator(MemSize);
+  auto gen = uniform_generator(property_set, MemSize);
 
   auto build = ref.get_builder();
 
-  fmt::print("{}\n", build.signature());
+  if (OutputPath.empty()) {
+    fmt::print("{}\n", build.signature());
 
-  gen.gen_args(build);
-  dump_pre(build);
+    for (auto i = 0u; i < NumExamples; ++i) {
+      build.reset();
+      gen.gen_args(build);
+      dump_pre(build);
 
-  auto rv = ref.call(build);
-  dump_post(build);
+      auto rv = ref.call(build);
+      dump_post(build);
 
-  dump_rv(rv, property_set.type_signature.return_type);
+      dump_rv(rv, property_set.type_signature.return_type);
+    }
+  } else {
+    // The builders are reused for every example so that their storage is only
+    // allocated once.
+    auto writer = example_writer(OutputPath, build.signature());
+    auto output = build;
+
+    for (auto i = 0u; i < NumExamples; ++i) {
+      build.reset();
+      gen.gen_args(build);
+
+      output = build;
+      auto rv = ref.call(output);
+
+      writer.write(build, output, rv);
+    }
+
+    writer.close();
+  }
 
 } catch (props::parse_error& perr) {
   errs() << perr.what() << '\n';
   errs() << "  when parsing property set " << PropertiesPath << '\n';
   return 2;
+} catch (example_file_error& eerr) {
+  errs() << eerr.what() << '\n';
+  return 4;
 } catch (dyld_error& derr) {
   errs() << derr.what() << '\n';
   errs() << "  when loading dynamic library " << LibraryPath << '\n';
@@ -14,3 +14,16 @@ cl::OptionCategory
 cl::opt<int> MemSize(
     "memsize", cl::desc("Cube-root of maximum physical memory allocation size"),
     cl::value_desc("integer"), cl::init(32), cl::cat(Memory));
+
+cl::OptionCategory Output("Output options", "Controlling how examples are dumped");
+
+cl::opt<unsigned> NumExamples(
+    "n", cl::desc("Number of examples to generate and dump"),
+    cl::value_desc("examples"), cl::init(1), cl::cat(Output));
+
+cl::opt<std::string> OutputPath(
+    "o",
+    cl::desc("Write examples to this file in the binary example format "
+             "(see support/example_file.h) rather than printing them as text "
+             "('-' for standard output)"),
+    cl::value_desc("filename"), cl::cat(Output));
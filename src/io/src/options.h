@@ -6,3 +6,6 @@ extern llvm::cl::opt<std::string> PropertiesPath;
 extern llvm::cl::opt<std::string> LibraryPath;
 
 extern llvm::cl::opt<int> MemSize;
+
+extern llvm::cl::opt<unsigned> NumExamples;
+extern llvm::cl::opt<std::string> OutputPath;
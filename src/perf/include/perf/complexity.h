@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace perf {
+
+/**
+ * The asymptotic complexity classes that measured running times are fitted
+ * against.
+ */
+enum class complexity_class { constant, linear, linearithmic, quadratic, cubic };
+
+std::string to_string(complexity_class);
+
+/**
+ * A fitted model time(n) = intercept + coefficient * f(n), where f is the
+ * growth function of the complexity class.
+ */
+struct complexity_fit {
+  complexity_class model;
+
+  double intercept;
+  double coefficient;
+
+  // Sum of squared relative residuals, and the Bayesian information criterion
+  // derived from it (lower is better).
+  double error;
+  double bic;
+
+  double predict(double n) const;
+};
+
+/**
+ * Fits candidate complexity classes to (size, time) measurements as they are
+ * taken, so that a sweep can stop as soon as the class is clear and can spend
+ * its measurements where the candidates disagree.
+ *
+ * Models are fitted by least squares on relative error, as timing noise tends
+ * to be proportional to the time being measured. Candidates are compared by
+ * BIC; the class is considered settled once every other candidate is either
+ * clearly worse, or makes practically the same predictions as the best one
+ * over the measured range.
+ */
+class complexity_fitter {
+public:
+  /**
+   * evidence is the BIC difference needed to rule out a rival model (6 is
+   * conventionally "strong" evidence), and tolerance is the largest relative
+   * difference between predictions for two models to be considered
+   * equivalent.
+   */
+  explicit complexity_fitter(double evidence = 6.0, double tolerance = 0.1);
+
+  void add(double n, double time);
+
+  size_t size() const;
+
+  /**
+   * Fit every candidate class to the measurements so far, best first.
+   */
+  std::vector<complexity_fit> fits() const;
+
+  complexity_fit best() const;
+
+  bool settled() const;
+
+  /**
+   * Suggest the next size to measure: the geometric midpoint of the gap
+   * between measured sizes where the best model and its rivals disagree the
+   * most. Returns nothing if there are no rivals left, or every gap is
+   * already too small to split.
+   */
+  std::optional<long> next_point() const;
+
+private:
+  // Rival fits that are not clearly worse than the best one, and that make
+  // materially different predictions over the measured range.
+  std::vector<complexity_fit> rivals(std::vector<complexity_fit> const&) const;
+
+  double disagreement(
+      complexity_fit const& a, complexity_fit const& b, double n) const;
+
+  std::vector<double> sizes() const;
+
+  double evidence_;
+  double tolerance_;
+
+  std::vector<std::pair<double, double>> points_;
+};
+
+/**
+ * Geometrically spaced integer sizes from lo to hi inclusive, with each size
+ * roughly ratio times the previous one. The ratio must be greater than 1.
+ */
+std::vector<long> geometric_points(long lo, long hi, double ratio);
+
+} // namespace perf
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace perf {
+
+/**
+ * Where timing samples are read from. The steady clock measures wall time in
+ * nanoseconds; the cycle counter reads the processor's timestamp counter,
+ * which has much finer resolution and lower overhead but counts reference
+ * cycles rather than nanoseconds.
+ */
+enum class clock_source { steady, cycles };
+
+/**
+ * Returns true if the cycle counter clock source is supported on this
+ * platform.
+ */
+bool cycles_available();
+
+/**
+ * Robust summary statistics for a set of timing samples, in the units of the
+ * clock that produced them.
+ *
+ * The confidence interval is for the median, computed from order statistics
+ * so that it makes no assumption about the distribution of the samples (which
+ * for timings is typically skewed, with a long tail).
+ */
+struct summary {
+  size_t samples;
+  size_t outliers;
+
+  double median;
+  double mad;
+
+  double ci_low;
+  double ci_high;
+
+  // Total wall time spent taking the samples, including any setup.
+  std::chrono::nanoseconds elapsed;
+
+  double relative_ci() const;
+};
+
+/**
+ * Summarise a set of samples. Samples further than outlier_threshold scaled
+ * median absolute deviations from the median are discarded before computing
+ * the final statistics; a threshold of zero keeps every sample.
+ */
+summary summarise(std::vector<double> samples, double outlier_threshold);
+
+struct sampler_options {
+  clock_source clock = clock_source::steady;
+
+  // Untimed runs before sampling starts.
+  size_t warmup = 1;
+
+  size_t min_samples = 5;
+  size_t max_samples = 1000;
+
+  // Stop once the half-width of the 95% confidence interval for the median is
+  // at most this fraction of the median.
+  double target_ci = 0.02;
+
+  // Stop after this much time regardless of the confidence interval, even if
+  // fewer than min_samples have been taken.
+  std::chrono::nanoseconds max_time = std::chrono::seconds(1);
+
+  double outlier_threshold = 3.0;
+};
+
+/**
+ * Takes repeated timing samples of an operation until the estimate of its
+ * median running time is precise enough, or a sampling budget runs out.
+ */
+class sampler {
+public:
+  explicit sampler(sampler_options opts);
+
+  /**
+   * Measure body, calling prepare before every run to set up its input.
+   * Only the call to body is timed; it is passed the value returned from
+   * prepare.
+   */
+  template <typename Prepare, typename Body>
+  summary measure(Prepare&& prepare, Body&& body);
+
+  sampler_options const& options() const;
+
+private:
+  uint64_t start_time() const;
+  uint64_t end_time() const;
+
+  bool should_stop(
+      std::vector<double> const& samples,
+      std::chrono::steady_clock::time_point start);
+
+  sampler_options opts_;
+
+  // Sample count at which the confidence interval will next be checked.
+  size_t next_check_;
+};
+
+/**
+ * Pin the calling thread to a single CPU, so that measurements aren't
+ * disturbed by migrations between cores. Throws std::runtime_error if the
+ * affinity can't be set.
+ */
+void pin_to_cpu(int cpu);
+
+template <typename Prepare, typename Body>
+summary sampler::measure(Prepare&& prepare, Body&& body)
+{
+  for (auto i = 0u; i < opts_.warmup; ++i) {
+    body(prepare());
+  }
+
+  auto samples = std::vector<double> {};
+  // The time limit can stop sampling well before min_samples is reached, so
+  // don't trust it for a (possibly huge) up-front allocation.
+  samples.reserve(std::min<size_t>(opts_.min_samples, 1024));
+
+  next_check_ = opts_.min_samples;
+  auto start = std::chrono::steady_clock::now();
+
+  do {
+    auto&& input = prepare();
+
+    auto begin = start_time();
+    body(std::forward<decltype(input)>(input));
+    auto end = end_time();
+
+    samples.push_back(static_cast<double>(end - begin));
+  } while (!should_stop(samples, start));
+
+  auto result = summarise(std::move(samples), opts_.outlier_threshold);
+  result.elapsed = std::chrono::steady_clock::now() - start;
+  return result;
+}
+
+} // namespace perf
@@ -0,0 +1,261 @@
+#include <perf/complexity.h>
+
+#include <support/assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace perf {
+
+namespace {
+
+constexpr auto all_classes = {
+    complexity_class::constant, complexity_class::linear,
+    complexity_class::linearithmic, complexity_class::quadratic,
+    complexity_class::cubic};
+
+double growth(complexity_class cls, double n)
+{
+  switch (cls) {
+  case complexity_class::constant:
+    return 0;
+  case complexity_class::linear:
+    return n;
+  case complexity_class::linearithmic:
+    return n * std::log2(std::max(n, 1.0));
+  case complexity_class::quadratic:
+    return n * n;
+  case complexity_class::cubic:
+    return n * n * n;
+  }
+
+  return 0;
+}
+
+double weight(double time) { return time > 0 ? 1 / (time * time) : 1; }
+
+} // namespace
+
+std::string to_string(complexity_class cls)
+{
+  switch (cls) {
+  case complexity_class::constant:
+    return "const";
+  case complexity_class::linear:
+    return "linear";
+  case complexity_class::linearithmic:
+    return "nlogn";
+  case complexity_class::quadratic:
+    return "poly(2)";
+  case complexity_class::cubic:
+    return "poly(3)";
+  }
+
+  return "unknown";
+}
+
+double complexity_fit::predict(double n) const
+{
+  return intercept + coefficient * growth(model, n);
+}
+
+complexity_fitter::complexity_fitter(double evidence, double tolerance)
+    : evidence_(evidence)
+    , tolerance_(tolerance)
+    , points_ {}
+{
+}
+
+void complexity_fitter::add(double n, double time)
+{
+  points_.emplace_back(n, time);
+}
+
+size_t complexity_fitter::size() const { return points_.size(); }
+
+std::vector<complexity_fit> complexity_fitter::fits() const
+{
+  auto ret = std::vector<complexity_fit> {};
+  auto m = static_cast<double>(points_.size());
+
+  for (auto cls : all_classes) {
+    // Weighted least squares for time = a + b * f(n), with weights chosen so
+    // that the residuals are relative errors.
+    auto s = 0.0, sf = 0.0, sff = 0.0, sy = 0.0, sfy = 0.0;
+
+    for (auto [n, y] : points_) {
+      auto w = weight(y);
+      auto f = growth(cls, n);
+
+      s += w;
+      sf += w * f;
+      sff += w * f * f;
+      sy += w * y;
+      sfy += w * f * y;
+    }
+
+    auto a = s > 0 ? sy / s : 0.0;
+    auto b = 0.0;
+    auto params = 1.0;
+
+    auto det = s * sff - sf * sf;
+    if (cls != complexity_class::constant && det > 0) {
+      params = 2;
+      b = (s * sfy - sf * sy) / det;
+      a = (sy - b * sf) / s;
+
+      // Running times can't shrink as the problem grows, and a negative
+      // intercept means the fixed overhead is negligible.
+      if (a < 0) {
+        a = 0;
+        b = sff > 0 ? sfy / sff : 0;
+      }
+
+      if (b < 0) {
+        b = 0;
+        a = sy / s;
+      }
+    }
+
+    auto fit = complexity_fit {cls, a, b, 0, 0};
+    for (auto [n, y] : points_) {
+      auto r = y - fit.predict(n);
+      fit.error += weight(y) * r * r;
+    }
+
+    auto err = std::max(fit.error, std::numeric_limits<double>::min());
+    fit.bic = m * std::log(err / std::max(m, 1.0)) + params * std::log(m);
+
+    ret.push_back(fit);
+  }
+
+  std::stable_sort(ret.begin(), ret.end(), [](auto const& a, auto const& b) {
+    return a.bic < b.bic;
+  });
+
+  return ret;
+}
+
+complexity_fit complexity_fitter::best() const { return fits().front(); }
+
+bool complexity_fitter::settled() const
+{
+  // Too few points, or too narrow a range of sizes, can't distinguish growth
+  // rates however good the fit looks.
+  auto ns = sizes();
+  if (ns.size() < 5 || ns.back() < 8 * std::max(ns.front(), 1.0)) {
+    return false;
+  }
+
+  return rivals(fits()).empty();
+}
+
+std::optional<long> complexity_fitter::next_point() const
+{
+  auto all = fits();
+  auto rs = rivals(all);
+  if (rs.empty()) {
+    return std::nullopt;
+  }
+
+  auto ns = sizes();
+  auto best_point = std::optional<long> {};
+  auto best_score = -1.0;
+
+  for (auto i = 0u; i + 1 < ns.size(); ++i) {
+    auto mid = std::lround(std::sqrt(std::max(ns[i], 1.0) * ns[i + 1]));
+    if (mid <= ns[i] || mid >= ns[i + 1]) {
+      continue;
+    }
+
+    auto score = 0.0;
+    for (auto const& r : rs) {
+      score = std::max(score, disagreement(all.front(), r, mid));
+    }
+
+    if (score > best_score) {
+      best_score = score;
+      best_point = mid;
+    }
+  }
+
+  return best_point;
+}
+
+std::vector<complexity_fit>
+complexity_fitter::rivals(std::vector<complexity_fit> const& all) const
+{
+  auto ns = sizes();
+  auto const& best = all.front();
+
+  auto ret = std::vector<complexity_fit> {};
+
+  for (auto it = std::next(all.begin()); it != all.end(); ++it) {
+    if (it->bic - best.bic >= evidence_) {
+      continue;
+    }
+
+    auto max_diff = 0.0;
+    for (auto n : ns) {
+      max_diff = std::max(max_diff, disagreement(best, *it, n));
+    }
+
+    if (max_diff > tolerance_) {
+      ret.push_back(*it);
+    }
+  }
+
+  return ret;
+}
+
+double complexity_fitter::disagreement(
+    complexity_fit const& a, complexity_fit const& b, double n) const
+{
+  auto pa = a.predict(n);
+  auto pb = b.predict(n);
+  auto scale = std::max(std::abs(pa), std::abs(pb));
+
+  return scale > 0 ? std::abs(pa - pb) / scale : 0;
+}
+
+std::vector<double> complexity_fitter::sizes() const
+{
+  auto ret = std::vector<double> {};
+  for (auto [n, y] : points_) {
+    ret.push_back(n);
+  }
+
+  std::sort(ret.begin(), ret.end());
+  ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+  return ret;
+}
+
+std::vector<long> geometric_points(long lo, long hi, double ratio)
+{
+  assumes(
+      ratio > 1, "Ratio between points must be greater than 1 (got {})", ratio);
+
+  auto ret = std::vector<long> {};
+  if (hi < lo) {
+    return ret;
+  }
+
+  auto x = static_cast<double>(std::max(lo, 1L));
+  while (x < hi) {
+    auto n = std::lround(x);
+    if (ret.empty() || n > ret.back()) {
+      ret.push_back(n);
+    }
+
+    x *= ratio;
+  }
+
+  if (ret.empty() || ret.back() < hi) {
+    ret.push_back(hi);
+  }
+
+  return ret;
+}
+
+} // namespace perf
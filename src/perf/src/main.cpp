@@ -1,14 +1,20 @@
 #include "options.h"
 
+#include <perf/complexity.h>
+#include <perf/measurement.h>
+
 #include <props/props.h>
 
 #include <support/argument_generator.h>
 #include <support/bit_cast.h>
 #include <support/call_wrapper.h>
 #include <support/dynamic_library.h>
+#include <support/filesystem.h>
 #include <support/llvm_format.h>
 #include <support/options.h>
+#include <support/ordered_writer.h>
 #include <support/thread_context.h>
+#include <support/work_queue.h>
 
 #include <fmt/format.h>
 
@@ -16,7 +22,10 @@
 #include <llvm/Support/CommandLine.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <memory>
 #include <string_view>
 #include <type_traits>
 
@@ -35,48 +44,163 @@ void warmup(call_wrapper& ref)
 }
 
 template <typename... Args>
-void print(Args&&... args)
+void print(std::string& out, Args&&... args)
 {
   if (!Quiet) {
-    fmt::print(std::forward<Args>(args)...);
+    out += fmt::format(std::forward<Args>(args)...);
   }
 }
 
+perf::sampler make_sampler()
+{
+  auto opts = perf::sampler_options {};
+  opts.clock = Clock;
+  opts.min_samples = MinReps;
+  opts.max_samples = MaxReps;
+  opts.target_ci = TargetCI;
+  opts.max_time = std::chrono::milliseconds(MaxTime);
+  opts.outlier_threshold = OutlierThreshold;
+
+  return perf::sampler(opts);
+}
+
+/**
+ * Adaptively sample calls to the wrapped function. prepare is called (untimed)
+ * before each sample, and returns the argument pack to call with.
+ */
+template <typename Prepare>
+perf::summary measure(call_wrapper& ref, Prepare&& prepare)
+{
+  auto entry = ref.raw_entry();
+
+  return make_sampler().measure(
+      [&] { return prepare().args(); }, [&](uint8_t* args) { entry(args); });
+}
+
+/**
+ * Approximate wall time per sample, used to cut off sweeps that have become
+ * too slow to be worth continuing.
+ */
+std::chrono::nanoseconds time_per_sample(perf::summary const& s)
+{
+  if (Clock == perf::clock_source::steady) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(s.median));
+  }
+
+  return s.elapsed / s.samples;
+}
+
+template <typename Value>
+void print_summary(
+    std::string& out, std::string_view param, Value val,
+    perf::summary const& s, std::string_view tag)
+{
+  if (!param.empty()) {
+    print(out, "{},", param);
+  }
+
+  print(
+      out, "{},{},{},{},{},{},{},{}\n", val, s.median, s.mad, s.ci_low,
+      s.ci_high, s.samples, s.outliers, tag);
+}
+
+/**
+ * Sweep a parameter over geometrically spaced sizes, fitting complexity
+ * classes as measurements come in and refining where they disagree, until the
+ * class is settled. measure_point takes a size and returns its estimated
+ * running time, along with whether the sweep should go no further.
+ */
+template <typename MeasureF>
+void run_fit(
+    std::string_view param, std::string_view tag, std::string& fit_out,
+    MeasureF&& measure_point)
+{
+  auto fitter = perf::complexity_fitter();
+
+  for (auto n : perf::geometric_points(Start, End - 1, Ratio)) {
+    auto [time, too_slow] = measure_point(n);
+    fitter.add(n, time);
+
+    if (too_slow) {
+      break;
+    }
+  }
+
+  while (!fitter.settled() && fitter.size() < size_t(MaxPoints)) {
+    auto next = fitter.next_point();
+    if (!next) {
+      break;
+    }
+
+    fitter.add(*next, measure_point(*next).first);
+  }
+
+  auto fit = fitter.best();
+  fit_out += fmt::format(
+      "{},{},{},{},{},{},{}\n", tag, param, to_string(fit.model),
+      fit.intercept, fit.coefficient, fitter.size(), fitter.settled());
+}
+
 void run_fixed(
-    std::vector<std::string> params, call_wrapper& ref, std::string_view tag)
+    property_set const& ps, std::vector<std::string> params, call_wrapper& ref,
+    std::string_view tag, std::string& out, std::string& fit_out)
 {
   warmup(ref);
 
-  print("param,value,time,tag\n");
-
   for (auto i = 0u; i < params.size(); ++i) {
-    auto gen
-        = override_generator(std::unordered_map<std::string, long> {}, MemSize);
+    auto gen = override_generator(
+        std::unordered_map<std::string, long> {}, ps, MemSize);
 
     for (auto i = 1u; i < params.size(); ++i) {
       gen.set_value(params[i], Independent);
     }
 
-    auto done = false;
-
-    for (int val = Start; val < End; val += Step) {
+    auto measure_point = [&](long val) -> std::pair<double, bool> {
       gen.set_value(params[0], val);
 
+      if (Adaptive) {
+        // As with the raw samples, every sample gets a freshly generated
+        // input so that the statistics reflect variation across inputs.
+        auto b = ref.get_builder();
+        auto s = measure(ref, [&]() -> call_builder& {
+          b.reset();
+          gen.gen_args(b);
+          return b;
+        });
+
+        print_summary(out, params[0], val, s, tag);
+
+        return {
+            s.median, time_per_sample(s) > std::chrono::milliseconds(100)};
+      }
+
+      auto total = 0.0;
+      auto too_slow = false;
+
       for (auto i = 0; i < Reps; ++i) {
         auto b = ref.get_builder();
         gen.gen_args(b);
 
         auto [res, t] = ref.call_timed(b);
-        print("{},{},{},{}\n", params[0], val, t.count(), tag);
+        print(out, "{},{},{},{}\n", params[0], val, t.count(), tag);
 
+        total += t.count();
         if (t.count() > 100'000'000) {
-          done = true;
+          too_slow = true;
         }
       }
 
-      if (done) {
-        break;
+      return {total / std::max(int(Reps), 1), too_slow};
+    };
+
+    if (FitOutput.empty()) {
+      for (int val = Start; val < End; val += Step) {
+        if (measure_point(val).second) {
+          break;
+        }
       }
+    } else {
+      run_fit(params[0], tag, fit_out, measure_point);
     }
 
     std::rotate(params.begin(), params.begin() + 1, params.end());
@@ -84,58 +208,74 @@ void run_fixed(
 }
 
 void run_random(
-    std::vector<std::string> params, call_wrapper& ref, std::string_view tag)
+    property_set const& ps, std::vector<std::string> params, call_wrapper& ref,
+    std::string_view tag, std::string& out)
 {
   warmup(ref);
 
-  auto gen_base = uniform_generator(128);
+  auto gen_base = uniform_generator(ps, 128);
   gen_base.int_min = Min;
   gen_base.int_max = Max;
   gen_base.float_min = float(Min);
   gen_base.float_max = float(Max);
 
-  print("param,value,time,tag\n");
-
   for (auto const& param : params) {
     for (int val = 0; val < Values; ++val) {
       auto b = ref.get_builder();
       gen_base.gen_args(b);
 
+      // Assigning into the same scratch pack reuses its storage, so the
+      // repetitions don't allocate.
+      auto clone = b;
+
+      if (Adaptive) {
+        auto s = measure(ref, [&]() -> call_builder& { return clone = b; });
+        print_summary(out, param, b.get<int64_t>(param), s, tag);
+        continue;
+      }
+
       for (auto i = 0; i < Reps; ++i) {
-        auto clone = b;
+        clone = b;
 
         auto [res, t] = ref.call_timed(clone);
         auto used_arg = clone.get<int64_t>(param);
 
-        print("{},{},{},{}\n", param, used_arg, t.count(), tag);
+        print(out, "{},{},{},{}\n", param, used_arg, t.count(), tag);
       }
     }
   }
 }
 
 void run_single(
-    std::vector<std::string> params, call_wrapper& ref, std::string_view tag)
+    property_set const& ps, std::vector<std::string> params, call_wrapper& ref,
+    std::string_view tag, std::string& out)
 {
   warmup(ref);
 
-  auto gen
-      = override_generator(std::unordered_map<std::string, long> {}, MemSize);
+  auto gen = override_generator(
+      std::unordered_map<std::string, long> {}, ps, MemSize);
 
   for (auto const& param : params) {
     gen.set_value(param, Independent);
   }
 
-  print("value,time,tag\n");
-
   auto b = ref.get_builder();
   gen.gen_args(b);
 
+  auto clone = b;
+
+  if (Adaptive) {
+    auto s = measure(ref, [&]() -> call_builder& { return clone = b; });
+    print_summary(out, "", int(Independent), s, tag);
+    return;
+  }
+
   for (auto i = 0; i < Reps; ++i) {
-    auto clone = b;
+    clone = b;
 
     auto [res, t] = ref.call_timed(clone);
 
-    print("{},{},{}\n", Independent, t.count(), tag);
+    print(out, "{},{},{}\n", Independent, t.count(), tag);
   }
 }
 
@@ -148,26 +288,41 @@ void normalise_names(property_set& ps)
   })}.visit(ps.type_signature);
 }
 
-int main(int argc, char** argv)
-try {
-  LLVMInitializeNativeTarget();
-  LLVMInitializeNativeAsmPrinter();
-  LLVMInitializeNativeAsmParser();
+std::vector<std::string> get_property_paths()
+{
+  if (!filesystem::is_directory(PropertiesPath.getValue())) {
+    return {PropertiesPath};
+  }
 
-  hide_llvm_options();
-  cl::ParseCommandLineOptions(argc, argv);
+  auto ret = std::vector<std::string> {};
+
+  for (auto const& entry :
+       filesystem::recursive_directory_iterator(PropertiesPath.getValue())) {
+    if (entry.path().extension() == ".props") {
+      ret.push_back(entry.path().string());
+    }
+  }
+
+  // Sorted so that the merged output is in the same order on every run.
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
 
-  auto property_set = props::property_set::load(PropertiesPath);
-  normalise_names(property_set);
+struct entry_output {
+  std::string samples;
+  std::string fits;
+};
 
-  auto fn_name = property_set.type_signature.name;
+entry_output run_entry(property_set const& ps, dynamic_library const& lib)
+{
+  auto fn_name = ps.type_signature.name;
 
   auto params = [&]() -> std::vector<std::string> {
     if (Parameters.empty()) {
       auto ret = std::vector<std::string> {};
       sig_visitor {on(base_type::integer, [&](auto const& p) {
         ret.push_back(p.name);
-      })}.visit(property_set.type_signature);
+      })}.visit(ps.type_signature);
       return ret;
     } else {
       return Parameters;
@@ -176,40 +331,116 @@ try {
 
   auto tag = [&]() -> std::string {
     if (Tag.empty()) {
-      return property_set.type_signature.name;
+      return ps.type_signature.name;
     } else {
       return Tag;
     }
   }();
 
-  auto lib = dynamic_library(LibraryPath);
-  auto disable_trace = lib.symbol<void()>("disable_trace");
-  disable_trace();
-
   auto mod = Module("perf_internal", thread_context::get());
-  auto ref = call_wrapper(property_set.type_signature, mod, fn_name, lib);
+  auto ref = call_wrapper(ps.type_signature, mod, fn_name, lib);
+
+  auto out = entry_output {};
 
   switch (Mode) {
   case LinearSpace:
-    run_fixed(params, ref, tag);
-    return 0;
+    run_fixed(ps, params, ref, tag, out.samples, out.fits);
+    break;
   case Random:
-    run_random(params, ref, tag);
-    return 0;
+    run_random(ps, params, ref, tag, out.samples);
+    break;
   case Single:
-    run_single(params, ref, tag);
-    return 0;
+    run_single(ps, params, ref, tag, out.samples);
+    break;
   default:
     unimplemented();
   }
-} catch (props::parse_error& perr) {
-  fmt::print(
-      stderr, "{}\n  when parsing property set {}\n", perr.what(),
-      PropertiesPath);
-  return 2;
-} catch (dyld_error& derr) {
-  fmt::print(
-      stderr, "{}\n  when loading dynamic library {}\n", derr.what(),
-      LibraryPath);
-  return 3;
+
+  return out;
+}
+
+int main(int argc, char** argv)
+{
+  LLVMInitializeNativeTarget();
+  LLVMInitializeNativeAsmPrinter();
+  LLVMInitializeNativeAsmParser();
+
+  hide_llvm_options();
+  cl::ParseCommandLineOptions(argc, argv);
+
+  // Written so that NaN is rejected as well.
+  if (!(Ratio > 1)) {
+    fmt::print(stderr, "-ratio must be greater than 1 (got {})\n", Ratio);
+    return 1;
+  }
+
+  auto inputs = std::vector<property_set> {};
+
+  for (auto const& path : get_property_paths()) {
+    try {
+      inputs.push_back(props::property_set::load(path));
+      normalise_names(inputs.back());
+    } catch (props::parse_error& perr) {
+      fmt::print(
+          stderr, "{}\n  when parsing property set {}\n", perr.what(), path);
+      return 2;
+    }
+  }
+
+  try {
+    auto lib = dynamic_library(LibraryPath);
+    auto disable_trace = lib.symbol<void()>("disable_trace");
+    disable_trace();
+
+    if (!Quiet) {
+      auto stats = Adaptive ? "median,mad,ci_low,ci_high,samples,outliers"
+                            : "time";
+      fmt::print(
+          "{}value,{},tag\n", Mode == Single ? "" : "param,", stats);
+    }
+
+    auto fit_file = std::unique_ptr<std::FILE, int (*)(std::FILE*)>(
+        nullptr, std::fclose);
+
+    if (!FitOutput.empty()) {
+      fit_file.reset(std::fopen(FitOutput.c_str(), "w"));
+      if (!fit_file) {
+        throw std::runtime_error("Couldn't open fit output: " + FitOutput);
+      }
+
+      fmt::print(
+          fit_file.get(),
+          "function,param,model,intercept,coefficient,points,settled\n");
+    }
+
+    // Timings from entries that run concurrently will interfere with each
+    // other to some extent, so this is opt-in (see -jobs).
+    auto out = ordered_writer(stdout);
+    auto fit_out = ordered_writer(fit_file ? fit_file.get() : stdout);
+    auto worker_id = std::atomic<int> {0};
+
+    work_queue(Jobs).run(inputs.size(), [&] {
+      auto id = worker_id++;
+      if (PinCPU >= 0) {
+        perf::pin_to_cpu(PinCPU + id);
+      }
+
+      return [&](size_t idx) {
+        auto [samples, fits] = run_entry(inputs[idx], lib);
+
+        out.write(idx, std::move(samples));
+        if (fit_file) {
+          fit_out.write(idx, std::move(fits));
+        }
+      };
+    });
+  } catch (dyld_error& derr) {
+    fmt::print(
+        stderr, "{}\n  when loading dynamic library {}\n", derr.what(),
+        LibraryPath);
+    return 3;
+  } catch (std::runtime_error& err) {
+    fmt::print(stderr, "{}\n", err.what());
+    return 4;
+  }
 }
@@ -0,0 +1,207 @@
+#include <perf/measurement.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PERF_HAS_TSC 1
+#else
+#define PERF_HAS_TSC 0
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace perf {
+
+namespace {
+
+// Normal quantile for a two-sided 95% interval.
+constexpr double z_95 = 1.959964;
+
+// Scales the MAD to be a consistent estimator of the standard deviation for
+// normally distributed data.
+constexpr double mad_scale = 1.4826;
+
+/**
+ * Median of a sorted range.
+ */
+double sorted_median(std::vector<double> const& sorted)
+{
+  auto n = sorted.size();
+  if (n == 0) {
+    return 0;
+  }
+
+  if (n % 2 == 1) {
+    return sorted[n / 2];
+  } else {
+    return (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+  }
+}
+
+double median_abs_deviation(std::vector<double> const& sorted, double median)
+{
+  auto devs = std::vector<double>(sorted.size());
+  std::transform(sorted.begin(), sorted.end(), devs.begin(), [&](auto x) {
+    return std::abs(x - median);
+  });
+
+  std::sort(devs.begin(), devs.end());
+  return sorted_median(devs);
+}
+
+} // namespace
+
+bool cycles_available() { return PERF_HAS_TSC; }
+
+double summary::relative_ci() const
+{
+  if (median == 0) {
+    return 0;
+  }
+
+  return (ci_high - ci_low) / (2 * median);
+}
+
+summary summarise(std::vector<double> samples, double outlier_threshold)
+{
+  std::sort(samples.begin(), samples.end());
+
+  auto total = samples.size();
+  auto median = sorted_median(samples);
+  auto mad = median_abs_deviation(samples, median);
+
+  if (outlier_threshold > 0 && mad > 0) {
+    auto limit = outlier_threshold * mad_scale * mad;
+
+    auto lo = std::lower_bound(samples.begin(), samples.end(), median - limit);
+    auto hi = std::upper_bound(samples.begin(), samples.end(), median + limit);
+
+    samples.erase(hi, samples.end());
+    samples.erase(samples.begin(), lo);
+
+    median = sorted_median(samples);
+    mad = median_abs_deviation(samples, median);
+  }
+
+  auto n = samples.size();
+  auto ret = summary {total, total - n, median, mad, median, median, {}};
+
+  if (n > 0) {
+    // Ranks of the order statistics bounding the median with 95% confidence,
+    // from the normal approximation to the binomial distribution.
+    auto half_width = z_95 * std::sqrt(static_cast<double>(n)) / 2;
+    auto centre = static_cast<double>(n - 1) / 2;
+
+    auto lo = static_cast<long>(std::floor(centre - half_width));
+    auto hi = static_cast<long>(std::ceil(centre + half_width));
+
+    ret.ci_low = samples[std::max(lo, 0L)];
+    ret.ci_high = samples[std::min(hi, static_cast<long>(n) - 1)];
+  }
+
+  return ret;
+}
+
+sampler::sampler(sampler_options opts)
+    : opts_(opts)
+    , next_check_(opts.min_samples)
+{
+  if (opts_.clock == clock_source::cycles && !cycles_available()) {
+    throw std::runtime_error("Cycle counter not available on this platform");
+  }
+
+  opts_.min_samples = std::max<size_t>(opts_.min_samples, 1);
+  opts_.max_samples = std::max(opts_.max_samples, opts_.min_samples);
+}
+
+sampler_options const& sampler::options() const { return opts_; }
+
+uint64_t sampler::start_time() const
+{
+#if PERF_HAS_TSC
+  if (opts_.clock == clock_source::cycles) {
+    // Don't let earlier instructions leak into the measured region.
+    _mm_lfence();
+    auto t = __rdtsc();
+    _mm_lfence();
+    return t;
+  }
+#endif
+
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+uint64_t sampler::end_time() const
+{
+#if PERF_HAS_TSC
+  if (opts_.clock == clock_source::cycles) {
+    // rdtscp waits for the measured instructions to complete, and the fence
+    // stops later ones from starting early.
+    auto aux = 0u;
+    auto t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+  }
+#endif
+
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+bool sampler::should_stop(
+    std::vector<double> const& samples,
+    std::chrono::steady_clock::time_point start)
+{
+  auto n = samples.size();
+
+  if (n >= opts_.max_samples) {
+    return true;
+  }
+
+  // The time budget takes priority over the minimum number of samples, so that
+  // slow operations still finish (with at least one sample to summarise).
+  if (n > 0 && std::chrono::steady_clock::now() - start >= opts_.max_time) {
+    return true;
+  }
+
+  if (n < opts_.min_samples) {
+    return false;
+  }
+
+  // Summarising needs a sort, so rather than doing it after every sample the
+  // interval is rechecked each time the sample count grows by 10%.
+  if (n < next_check_) {
+    return false;
+  }
+
+  next_check_ = std::max(n + 1, n + n / 10);
+
+  auto s = summarise(samples, opts_.outlier_threshold);
+  return s.relative_ci() <= opts_.target_ci;
+}
+
+void pin_to_cpu(int cpu)
+{
+#if defined(__linux__)
+  auto set = cpu_set_t {};
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    throw std::runtime_error(
+        "Couldn't pin thread to CPU " + std::to_string(cpu) + ": "
+        + std::strerror(errno));
+  }
+#else
+  throw std::runtime_error("CPU pinning is not supported on this platform");
+#endif
+}
+
+} // namespace perf
@@ -2,8 +2,9 @@
 
 using namespace llvm;
 
-cl::opt<std::string>
-    PropertiesPath(cl::Positional, cl::Required, cl::desc("<properties file>"));
+cl::opt<std::string> PropertiesPath(
+    cl::Positional, cl::Required,
+    cl::desc("<properties file, or directory of .props files>"));
 
 cl::opt<std::string>
     LibraryPath(cl::Positional, cl::Required, cl::desc("<shared library>"));
@@ -67,11 +68,97 @@ cl::alias IndependentA(
     "i", cl::desc("Alias for -independent"), cl::aliasopt(Independent),
     cl::cat(Experiments));
 
+cl::opt<unsigned> Jobs(
+    "jobs",
+    cl::desc("Number of property sets to measure in parallel when given a "
+             "directory (0 to use every hardware thread). Concurrent runs "
+             "compete for caches and memory bandwidth, so timings are noisier "
+             "than when running one at a time."),
+    cl::value_desc("integer"), cl::init(1), cl::cat(Experiments));
+
+cl::alias
+    JobsA("j", cl::desc("Alias for -jobs"), cl::aliasopt(Jobs),
+          cl::cat(Experiments));
+
+cl::OptionCategory Measurement(
+    "Measurement options",
+    "These control adaptive sampling of each point, which replaces a fixed "
+    "number of raw samples with summary statistics");
+
+cl::opt<bool> Adaptive(
+    "adaptive",
+    cl::desc("Sample each point until its median is known precisely, and "
+             "print the median, MAD and 95% confidence interval"),
+    cl::init(false), cl::cat(Measurement));
+
+cl::opt<unsigned> MinReps(
+    "min-reps", cl::desc("Minimum number of samples per point"),
+    cl::value_desc("integer"), cl::init(5), cl::cat(Measurement));
+
+cl::opt<unsigned> MaxReps(
+    "max-reps", cl::desc("Maximum number of samples per point"),
+    cl::value_desc("integer"), cl::init(1000), cl::cat(Measurement));
+
+cl::opt<double> TargetCI(
+    "target-ci",
+    cl::desc("Stop sampling once the confidence interval half-width is at "
+             "most this fraction of the median"),
+    cl::value_desc("fraction"), cl::init(0.02), cl::cat(Measurement));
+
+cl::opt<int> MaxTime(
+    "max-time", cl::desc("Time budget for sampling each point"),
+    cl::value_desc("milliseconds"), cl::init(1000), cl::cat(Measurement));
+
+cl::opt<double> OutlierThreshold(
+    "outliers",
+    cl::desc("Discard samples more than this many scaled MADs from the median "
+             "(0 to keep every sample)"),
+    cl::value_desc("number"), cl::init(3.0), cl::cat(Measurement));
+
+cl::opt<perf::clock_source> Clock(
+    "clock", cl::desc("Clock used to time samples:"),
+    cl::values(
+        clEnumValN(
+            perf::clock_source::steady, "steady", "Wall time (nanoseconds)"),
+        clEnumValN(
+            perf::clock_source::cycles, "cycles",
+            "Timestamp counter (reference cycles)")),
+    cl::init(perf::clock_source::steady), cl::cat(Measurement));
+
+cl::opt<int> PinCPU(
+    "pin",
+    cl::desc("Pin measurement to this CPU (with -jobs, each worker is pinned "
+             "to the next CPU along)"),
+    cl::value_desc("cpu"), cl::init(-1), cl::cat(Measurement));
+
+cl::OptionCategory Fitting(
+    "Complexity fitting options",
+    "These control online fitting of complexity classes in linear mode");
+
+cl::opt<std::string> FitOutput(
+    "fit",
+    cl::desc("Fit complexity classes while sweeping, sampling sizes "
+             "geometrically between -start and -end instead of every -step, "
+             "and write the fitted classes to this file"),
+    cl::value_desc("path"), cl::init(""), cl::cat(Fitting));
+
+cl::opt<double> Ratio(
+    "ratio", cl::desc("Ratio between sizes in the initial fitting sweep"),
+    cl::value_desc("number"), cl::init(4.0), cl::cat(Fitting));
+
+cl::opt<int> MaxPoints(
+    "max-points",
+    cl::desc("Maximum number of sizes to measure for each parameter when "
+             "fitting"),
+    cl::value_desc("integer"), cl::init(48), cl::cat(Fitting));
+
 cl::OptionCategory
     Memory("Memory options", "Fine-tuning memory allocation sizes and checks");
 
 cl::opt<int> MemSize(
-    "memsize", cl::desc("Cube-root of maximum physical memory allocation size"),
+    "memsize",
+    cl::desc("Cube-root of the allocation size for pointers without a size "
+             "property"),
     cl::value_desc("integer"), cl::init(32), cl::cat(Memory));
 
 cl::opt<bool> Quiet(
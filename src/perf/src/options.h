@@ -1,5 +1,7 @@
 #pragma once
 
+#include <perf/measurement.h>
+
 #include <llvm/Support/CommandLine.h>
 
 enum PerfMode { Random, LinearSpace, Single };
@@ -20,6 +22,20 @@ extern llvm::cl::opt<int> Reps;
 extern llvm::cl::opt<int> Min;
 extern llvm::cl::opt<int> Max;
 extern llvm::cl::opt<int> Independent;
+extern llvm::cl::opt<unsigned> Jobs;
+
+extern llvm::cl::opt<bool> Adaptive;
+extern llvm::cl::opt<unsigned> MinReps;
+extern llvm::cl::opt<unsigned> MaxReps;
+extern llvm::cl::opt<double> TargetCI;
+extern llvm::cl::opt<int> MaxTime;
+extern llvm::cl::opt<double> OutlierThreshold;
+extern llvm::cl::opt<perf::clock_source> Clock;
+extern llvm::cl::opt<int> PinCPU;
+
+extern llvm::cl::opt<std::string> FitOutput;
+extern llvm::cl::opt<double> Ratio;
+extern llvm::cl::opt<int> MaxPoints;
 
 extern llvm::cl::opt<int> MemSize;
 
@@ -0,0 +1,92 @@
+#include <perf/complexity.h>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <functional>
+#include <random>
+
+using namespace perf;
+
+namespace {
+
+/**
+ * Run the same adaptive sweep that perf-model does against a synthetic cost
+ * function with multiplicative noise, returning the fitter at the end.
+ */
+complexity_fitter
+sweep(std::function<double(double)> cost, size_t max_points = 48)
+{
+  auto engine = std::default_random_engine(0);
+  auto noise = std::normal_distribution<double>(1.0, 0.03);
+
+  auto fitter = complexity_fitter();
+  auto measure = [&](long n) { fitter.add(n, cost(n) * noise(engine)); };
+
+  for (auto n : geometric_points(1, 3072, 4)) {
+    measure(n);
+  }
+
+  while (!fitter.settled() && fitter.size() < max_points) {
+    auto next = fitter.next_point();
+    if (!next) {
+      break;
+    }
+
+    measure(*next);
+  }
+
+  return fitter;
+}
+
+} // namespace
+
+TEST_CASE("Geometric points cover the range")
+{
+  REQUIRE(geometric_points(1, 64, 4) == std::vector<long> {1, 4, 16, 64});
+  REQUIRE(geometric_points(0, 10, 4) == std::vector<long> {1, 4, 10});
+  REQUIRE(geometric_points(5, 5, 2) == std::vector<long> {5});
+  REQUIRE(geometric_points(5, 4, 2).empty());
+}
+
+TEST_CASE("Exact data is fitted exactly")
+{
+  auto fitter = complexity_fitter();
+  for (auto n : {1, 2, 4, 8, 16, 32, 64}) {
+    fitter.add(n, 10 + 3 * n * n);
+  }
+
+  auto fit = fitter.best();
+  REQUIRE(fit.model == complexity_class::quadratic);
+  REQUIRE(fit.intercept == Approx(10));
+  REQUIRE(fit.coefficient == Approx(3));
+  REQUIRE(fitter.settled());
+}
+
+TEST_CASE("Fitting needs a wide enough range of sizes")
+{
+  auto fitter = complexity_fitter();
+  for (auto n : {100, 101, 102, 103, 104, 105}) {
+    fitter.add(n, n);
+  }
+
+  REQUIRE(!fitter.settled());
+}
+
+TEST_CASE("Adaptive sweeps identify complexity classes")
+{
+  using cc = complexity_class;
+
+  auto check = [](auto cost, auto expected) {
+    auto fitter = sweep(cost);
+
+    REQUIRE(fitter.best().model == expected);
+    REQUIRE(fitter.size() <= 48);
+  };
+
+  check([](double) { return 500.0; }, cc::constant);
+  check([](double n) { return 200 + 5 * n; }, cc::linear);
+  check([](double n) { return 200 + 5 * n * std::log2(n); }, cc::linearithmic);
+  check([](double n) { return 200 + 0.5 * n * n; }, cc::quadratic);
+  check([](double n) { return 200 + 0.01 * n * n * n; }, cc::cubic);
+}
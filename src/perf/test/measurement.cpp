@@ -0,0 +1,145 @@
+#include <perf/measurement.h>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace perf;
+
+TEST_CASE("Can summarise samples")
+{
+  SECTION("Odd number of samples")
+  {
+    auto s = summarise({5, 1, 3, 2, 4}, 0);
+
+    REQUIRE(s.samples == 5);
+    REQUIRE(s.outliers == 0);
+    REQUIRE(s.median == 3);
+    REQUIRE(s.mad == 1);
+    REQUIRE(s.ci_low <= s.median);
+    REQUIRE(s.ci_high >= s.median);
+  }
+
+  SECTION("Even number of samples")
+  {
+    auto s = summarise({4, 1, 3, 2}, 0);
+    REQUIRE(s.median == Approx(2.5));
+  }
+
+  SECTION("Identical samples")
+  {
+    auto s = summarise(std::vector<double>(20, 7.0), 3.0);
+
+    REQUIRE(s.median == 7);
+    REQUIRE(s.mad == 0);
+    REQUIRE(s.outliers == 0);
+    REQUIRE(s.relative_ci() == 0);
+  }
+}
+
+TEST_CASE("Outliers are discarded")
+{
+  auto samples = std::vector<double>(100);
+  std::iota(samples.begin(), samples.end(), 1000.0);
+  samples.push_back(1'000'000);
+  samples.push_back(2'000'000);
+
+  auto kept = summarise(samples, 3.0);
+  REQUIRE(kept.samples == 102);
+  REQUIRE(kept.outliers == 2);
+  REQUIRE(kept.ci_high < 1100);
+
+  auto all = summarise(samples, 0);
+  REQUIRE(all.outliers == 0);
+}
+
+TEST_CASE("Confidence intervals narrow with more samples")
+{
+  auto make = [](auto n) {
+    auto ret = std::vector<double>(n);
+    for (auto i = 0u; i < n; ++i) {
+      ret[i] = 100 + (i * 37) % 11;
+    }
+    return ret;
+  };
+
+  auto small = summarise(make(10u), 0);
+  auto large = summarise(make(1000u), 0);
+
+  REQUIRE(small.ci_low <= small.median);
+  REQUIRE(small.ci_high >= small.median);
+  REQUIRE(
+      large.ci_high - large.ci_low <= small.ci_high - small.ci_low);
+}
+
+TEST_CASE("Sampler stops once the interval is tight enough")
+{
+  auto opts = sampler_options {};
+  opts.min_samples = 10;
+  opts.max_samples = 10'000;
+  opts.target_ci = 0.5;
+
+  auto prepares = 0;
+  auto runs = 0;
+
+  auto s = sampler(opts).measure(
+      [&] { return ++prepares; },
+      [&](int) {
+        ++runs;
+        auto x = 0;
+        for (volatile auto i = 0; i < 1000; ++i) {
+          x += i;
+        }
+      });
+
+  REQUIRE(prepares == runs);
+  REQUIRE(s.samples >= 10);
+  REQUIRE(s.samples < 10'000);
+  REQUIRE(s.median > 0);
+  REQUIRE(runs == static_cast<int>(s.samples + opts.warmup));
+}
+
+TEST_CASE("Sampler respects its sample limit")
+{
+  auto opts = sampler_options {};
+  opts.min_samples = 3;
+  opts.max_samples = 7;
+  opts.target_ci = 0;
+
+  auto s = sampler(opts).measure([] { return 0; }, [](int) {});
+  REQUIRE(s.samples == 7);
+}
+
+TEST_CASE("Sampler stops at its time limit before the minimum sample count")
+{
+  auto opts = sampler_options {};
+  opts.min_samples = std::numeric_limits<size_t>::max();
+  opts.max_time = std::chrono::milliseconds(20);
+
+  auto s = sampler(opts).measure([] { return 0; }, [](int) {});
+  REQUIRE(s.samples >= 1);
+  REQUIRE(s.samples < opts.min_samples);
+}
+
+TEST_CASE("Sampler can use the cycle counter")
+{
+  if (!cycles_available()) {
+    return;
+  }
+
+  auto opts = sampler_options {};
+  opts.clock = clock_source::cycles;
+  opts.max_samples = 50;
+
+  auto s = sampler(opts).measure(
+      [] { return 0; },
+      [](int) {
+        for (volatile auto i = 0; i < 100; ++i) {
+        }
+      });
+
+  REQUIRE(s.median > 0);
+}
@@ -0,0 +1,175 @@
+#include "annealing_filler.h"
+
+#include <support/assert.h>
+#include <support/random.h>
+
+#include <cmath>
+#include <random>
+
+using namespace support;
+using namespace llvm;
+
+namespace presyn {
+
+annealing::annealing()
+    : annealing(options {})
+{
+}
+
+annealing::annealing(options opts)
+    : opts_(opts)
+    , plan_ {}
+    , choices_ {}
+    , arities_ {}
+    , has_current_(false)
+    , current_score_(std::nullopt)
+    , current_choices_ {}
+    , current_arities_ {}
+    , run_best_(std::nullopt)
+    , best_(std::nullopt)
+    , best_choices_ {}
+    , temperature_(opts.initial_temperature)
+    , since_improvement_(0)
+    , steps_(0)
+    , restarts_(0)
+{
+  assumes(
+      opts_.cooling > 0 && opts_.cooling <= 1,
+      "Cooling factor {} must be in (0, 1]", opts_.cooling);
+}
+
+std::unique_ptr<filler> annealing::make_filler()
+{
+  return std::make_unique<annealing_filler>(*this);
+}
+
+size_t annealing::choose(size_t arity)
+{
+  assumes(arity > 0, "Can't choose from an empty set of options");
+
+  auto depth = choices_.size();
+  auto choice = depth < plan_.size() ? plan_[depth] % arity
+                                     : random_int<size_t>(0, arity - 1);
+
+  choices_.push_back(choice);
+  arities_.push_back(arity);
+  return choice;
+}
+
+void annealing::score(std::optional<int64_t> score)
+{
+  ++steps_;
+  ++since_improvement_;
+
+  if (score && (!run_best_ || *score < *run_best_)) {
+    run_best_ = score;
+    since_improvement_ = 0;
+  }
+
+  if (score && (!best_ || *score < *best_)) {
+    best_ = score;
+    best_choices_ = choices_;
+  }
+
+  if (accept(score)) {
+    has_current_ = true;
+    current_score_ = score;
+    current_choices_ = std::move(choices_);
+    current_arities_ = std::move(arities_);
+  }
+
+  choices_.clear();
+  arities_.clear();
+
+  temperature_ *= opts_.cooling;
+
+  if (since_improvement_ > opts_.patience) {
+    restart();
+  } else {
+    propose();
+  }
+}
+
+bool annealing::accept(std::optional<int64_t> score) const
+{
+  if (!has_current_ || !current_score_) {
+    return true;
+  }
+
+  if (!score) {
+    return false;
+  }
+
+  if (*score <= *current_score_) {
+    return true;
+  }
+
+  // Scores are compared relative to the current one so that the temperature
+  // doesn't depend on the scale of the error function.
+  auto delta = double(*score - *current_score_) / double(*current_score_ + 1);
+  auto p = std::exp(-delta / temperature_);
+
+  return std::uniform_real_distribution<double>(0, 1)(thread_random_engine())
+         < p;
+}
+
+void annealing::propose()
+{
+  auto mutable_holes = std::vector<size_t> {};
+  for (auto i = 0u; i < current_arities_.size(); ++i) {
+    if (current_arities_[i] > 1) {
+      mutable_holes.push_back(i);
+    }
+  }
+
+  // Nothing can be changed, so the only thing left to do is to start again
+  // from somewhere else.
+  if (mutable_holes.empty()) {
+    restart();
+    return;
+  }
+
+  auto hole = *uniform_sample(mutable_holes);
+  auto offset = random_int<size_t>(1, current_arities_[hole] - 1);
+
+  plan_ = current_choices_;
+  plan_[hole] = (plan_[hole] + offset) % current_arities_[hole];
+}
+
+void annealing::restart()
+{
+  ++restarts_;
+
+  plan_.clear();
+  has_current_ = false;
+  current_score_ = std::nullopt;
+  current_choices_.clear();
+  current_arities_.clear();
+
+  run_best_ = std::nullopt;
+  temperature_ = opts_.initial_temperature;
+  since_improvement_ = 0;
+}
+
+std::optional<int64_t> annealing::best() const { return best_; }
+
+std::vector<size_t> const& annealing::best_choices() const
+{
+  return best_choices_;
+}
+
+size_t annealing::steps() const { return steps_; }
+
+size_t annealing::restarts() const { return restarts_; }
+
+annealing_filler::annealing_filler(annealing& search)
+    : search_(search)
+{
+}
+
+size_t annealing_filler::choose(std::vector<Value*> const& generated)
+{
+  return search_.choose(generated.size());
+}
+
+} // namespace presyn
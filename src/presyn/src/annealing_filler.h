@@ -0,0 +1,119 @@
+#pragma once
+
+#include "rule_filler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace presyn {
+
+/**
+ * Fitness-guided search over the candidates that can be built from a sketch,
+ * using simulated annealing with restarts.
+ *
+ * As with enumeration, a candidate is identified by the sequence of choices
+ * made at each hole while it was built. Rather than walking every sequence,
+ * the search keeps a current candidate and proposes neighbours of it by
+ * changing a single one of its choices; the rest of the sequence is replayed
+ * as it was (wrapped around if a hole now has fewer options), and any holes
+ * beyond its end are filled at random.
+ *
+ * Each candidate is given a score by the caller (for example, the total error
+ * over a set of examples), where 0 means that the candidate is a solution and
+ * no score means that it couldn't be evaluated at all. Better neighbours are
+ * always accepted; worse ones are accepted with a probability that shrinks as
+ * the relative increase in score grows and as the temperature cools. If the
+ * best score since the last restart hasn't improved for a while, the search
+ * restarts from a fresh random candidate.
+ */
+class annealing {
+public:
+  struct options {
+    // Proposals without improving on the best score since the last restart
+    // before restarting again.
+    size_t patience = 64;
+
+    // Temperature at the start of each restart, multiplied by cooling after
+    // every proposal.
+    double initial_temperature = 1.0;
+    double cooling = 0.95;
+  };
+
+  annealing();
+  explicit annealing(options opts);
+
+  /**
+   * Create a filler that builds the currently proposed candidate. Each filler
+   * must be used to build exactly one candidate, followed by a call to
+   * score().
+   */
+  std::unique_ptr<filler> make_filler();
+
+  /**
+   * Record the choice made at the next hole of the candidate being built,
+   * given the number of options available there, and return it.
+   */
+  size_t choose(size_t arity);
+
+  /**
+   * Report the score of the candidate that was just built, and propose the
+   * next one.
+   */
+  void score(std::optional<int64_t>);
+
+  /**
+   * The best score reported so far, if any candidate could be evaluated.
+   */
+  std::optional<int64_t> best() const;
+
+  std::vector<size_t> const& best_choices() const;
+
+  size_t steps() const;
+  size_t restarts() const;
+
+private:
+  bool accept(std::optional<int64_t> score) const;
+  void propose();
+  void restart();
+
+  options opts_;
+
+  // The choices to replay for the candidate being built.
+  std::vector<size_t> plan_;
+
+  // The choices made, and the number available, at each hole of the candidate
+  // currently being built.
+  std::vector<size_t> choices_;
+  std::vector<size_t> arities_;
+
+  // The state that proposals are made from.
+  bool has_current_;
+  std::optional<int64_t> current_score_;
+  std::vector<size_t> current_choices_;
+  std::vector<size_t> current_arities_;
+
+  std::optional<int64_t> run_best_;
+  std::optional<int64_t> best_;
+  std::vector<size_t> best_choices_;
+
+  double temperature_;
+  size_t since_improvement_;
+  size_t steps_;
+  size_t restarts_;
+};
+
+class annealing_filler : public rule_filler {
+public:
+  explicit annealing_filler(annealing&);
+
+protected:
+  size_t choose(std::vector<llvm::Value*> const& generated) override;
+
+private:
+  annealing& search_;
+};
+
+} // namespace presyn
@@ -31,6 +31,7 @@ candidate::candidate(sketch&& sk, std::unique_ptr<filler> fill)
     , module_(std::move(sk.module_))
     , hole_type_(sk.ctx_.opaque_type())
     , type_convs_()
+    , dominance_(nullptr)
     , ctx_(std::move(sk.ctx_))
 {
   filler_->set_candidate(*this);
@@ -49,6 +50,13 @@ candidate::candidate(sketch&& sk, std::unique_ptr<filler> fill)
 
 sketch_context& candidate::ctx() { return ctx_; }
 
+dominance_index const& candidate::dominance() const
+{
+  assertion(
+      dominance_ != nullptr, "Dominance is only indexed while filling holes");
+  return *dominance_;
+}
+
 Type* candidate::hole_type() const { return hole_type_; }
 
 Function& candidate::function()
@@ -125,6 +133,8 @@ void candidate::choose_values()
 
   stub_visitor([&holes](auto& ci) { holes.push_back(&ci); }).visit(function());
 
+  dominance_ = std::make_unique<dominance_index>(function());
+
   while (!holes.empty()) {
     auto hole = holes.front();
     holes.pop_front();
@@ -151,6 +161,8 @@ void candidate::choose_values()
       hole->eraseFromParent();
     }
   }
+
+  dominance_.reset();
 }
 
 void candidate::resolve_operators()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "candidate_visitors.h"
+#include "dominance_index.h"
 #include "filler.h"
 #include "sketch_context.h"
 
@@ -36,6 +37,10 @@ public:
 
   sketch_context& ctx();
 
+  // Index of the values available at each point in the candidate function,
+  // only valid while holes are being filled (i.e. during choose_values).
+  dominance_index const& dominance() const;
+
 protected:
   // A converter is essentially the identity function, but one that performs
   // sensible conversions as well.
@@ -101,6 +106,10 @@ private:
 
   support::type_conversions type_convs_;
 
+  // Filling holes doesn't change the CFG, so the dominator tree used to find
+  // values available to each hole is computed once when filling begins.
+  std::unique_ptr<dominance_index> dominance_;
+
   sketch_context ctx_;
 };
 
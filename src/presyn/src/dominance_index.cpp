@@ -0,0 +1,72 @@
+#include "dominance_index.h"
+
+#include <support/assert.h>
+
+using namespace llvm;
+
+namespace presyn {
+
+dominance_index::dominance_index(Function& func)
+    : tree_(func)
+{
+}
+
+std::vector<Value*>
+dominance_index::dominating(Instruction* at, size_t limit) const
+{
+  auto bb = at->getParent();
+  assertion(bb != nullptr, "Query point does not have an enclosing BB");
+
+  auto ret = std::vector<Value*> {};
+  collect_from_dominators(bb, ret, limit);
+  return ret;
+}
+
+std::vector<Value*> dominance_index::live(Instruction* at, size_t limit) const
+{
+  auto bb = at->getParent();
+  assertion(bb != nullptr, "Query point does not have an enclosing BB");
+
+  auto ret = std::vector<Value*> {};
+
+  for (auto it = at->getReverseIterator(); ++it != bb->rend();) {
+    if (ret.size() >= limit) {
+      return ret;
+    }
+
+    if (!it->getType()->isVoidTy()) {
+      ret.push_back(&*it);
+    }
+  }
+
+  collect_from_dominators(bb, ret, limit);
+  return ret;
+}
+
+void dominance_index::collect_from_dominators(
+    BasicBlock* bb, std::vector<Value*>& out, size_t limit) const
+{
+  auto node = tree_.getNode(bb);
+  if (!node) {
+    // Unreachable blocks aren't dominated by anything.
+    return;
+  }
+
+  for (node = node->getIDom(); node; node = node->getIDom()) {
+    auto& dom_bb = *node->getBlock();
+
+    for (auto it = dom_bb.rbegin(); it != dom_bb.rend(); ++it) {
+      if (out.size() >= limit) {
+        return;
+      }
+
+      if (!it->getType()->isVoidTy()) {
+        out.push_back(&*it);
+      }
+    }
+  }
+}
+
+DominatorTree const& dominance_index::tree() const { return tree_; }
+
+} // namespace presyn
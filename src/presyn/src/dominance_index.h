@@ -0,0 +1,58 @@
+#pragma once
+
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instruction.h>
+#include <llvm/IR/Value.h>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace presyn {
+
+/**
+ * Answers "which values are available at this point?" queries for a function
+ * whose control flow is fixed, but whose instructions are being rewritten.
+ *
+ * Filling holes inserts and replaces instructions, but never adds or removes
+ * basic blocks, so the dominator tree computed on construction stays valid for
+ * the whole filling process. Queries walk up the tree from the query point
+ * rather than testing every instruction in the function, and read instructions
+ * directly from the blocks so that they always see the current IR without any
+ * bookkeeping when holes are filled.
+ *
+ * If the CFG is changed, the index must be rebuilt.
+ */
+class dominance_index {
+public:
+  explicit dominance_index(llvm::Function&);
+
+  /**
+   * Values defined by instructions in blocks that strictly dominate the block
+   * containing the query point, nearest first (i.e. walking backwards up the
+   * dominator tree). Void-typed instructions are skipped. At most limit values
+   * are returned, and the walk stops as soon as that many have been found.
+   */
+  std::vector<llvm::Value*> dominating(
+      llvm::Instruction*,
+      size_t limit = std::numeric_limits<size_t>::max()) const;
+
+  /**
+   * As above, but also including the instructions that precede the query
+   * point in its own block (which come first).
+   */
+  std::vector<llvm::Value*>
+  live(llvm::Instruction*, size_t limit = std::numeric_limits<size_t>::max())
+      const;
+
+  llvm::DominatorTree const& tree() const;
+
+private:
+  void collect_from_dominators(
+      llvm::BasicBlock*, std::vector<llvm::Value*>&, size_t limit) const;
+
+  llvm::DominatorTree tree_;
+};
+
+} // namespace presyn
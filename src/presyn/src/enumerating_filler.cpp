@@ -0,0 +1,129 @@
+#include "enumerating_filler.h"
+
+#include <support/assert.h>
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace llvm;
+
+namespace presyn {
+
+namespace {
+
+// Shards are assigned by hashing a group's prefix, rather than by numbering
+// groups as they're visited, so that ownership doesn't depend on where the
+// enumeration started from.
+size_t prefix_shard(std::vector<size_t> const& prefix, size_t num_shards)
+{
+  auto hash = uint64_t {prefix.size()};
+
+  for (auto choice : prefix) {
+    // Mix each choice in with the splitmix64 finaliser.
+    auto z = hash ^ (uint64_t {choice} + 0x9e3779b97f4a7c15 + (hash << 6));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    hash = z ^ (z >> 31);
+  }
+
+  return hash % num_shards;
+}
+
+} // namespace
+
+enumeration::enumeration(
+    size_t max_depth, size_t shard, size_t num_shards, size_t split_depth,
+    std::vector<size_t> cursor)
+    : max_depth_(max_depth)
+    , shard_(shard)
+    , num_shards_(num_shards)
+    , split_depth_(split_depth)
+    , cursor_(std::move(cursor))
+    , choices_ {}
+    , arities_ {}
+    , visited_(0)
+    , done_(false)
+{
+  assumes(num_shards_ > 0, "Enumeration must have at least one shard");
+  assumes(
+      shard_ < num_shards_, "Shard index {} out of range for {} shards", shard_,
+      num_shards_);
+}
+
+std::unique_ptr<filler> enumeration::make_filler()
+{
+  assumes(!done_, "Can't build candidates from a finished enumeration");
+  return std::make_unique<enumerating_filler>(*this);
+}
+
+size_t enumeration::choose(size_t arity)
+{
+  auto depth = choices_.size();
+  auto choice = depth < cursor_.size() ? cursor_[depth] : 0;
+
+  assertion(
+      choice < arity,
+      "Enumeration cursor doesn't match the sketch (choice {} of {} at depth "
+      "{})",
+      choice, arity, depth);
+
+  choices_.push_back(choice);
+  arities_.push_back(arity);
+  return choice;
+}
+
+bool enumeration::advance()
+{
+  assumes(!done_, "Can't advance a finished enumeration");
+
+  auto prefix_len = std::min(split_depth_, choices_.size());
+  auto prefix = std::vector<size_t>(
+      choices_.begin(), choices_.begin() + prefix_len);
+
+  ++visited_;
+
+  auto mine = prefix_shard(prefix, num_shards_) == shard_;
+
+  // Increment the deepest choice that still has options left (like an
+  // odometer), resetting everything after it. Groups belonging to other shards
+  // are skipped over entirely by only incrementing within their prefix.
+  auto limit = std::min(choices_.size(), max_depth_);
+  if (!mine) {
+    limit = std::min(limit, prefix_len);
+  }
+
+  auto next = limit;
+  while (next > 0 && choices_[next - 1] + 1 >= arities_[next - 1]) {
+    --next;
+  }
+
+  if (next == 0) {
+    done_ = true;
+  } else {
+    cursor_.assign(choices_.begin(), choices_.begin() + next);
+    cursor_.back()++;
+  }
+
+  choices_.clear();
+  arities_.clear();
+
+  return mine;
+}
+
+bool enumeration::done() const { return done_; }
+
+std::vector<size_t> const& enumeration::cursor() const { return cursor_; }
+
+size_t enumeration::visited() const { return visited_; }
+
+enumerating_filler::enumerating_filler(enumeration& en)
+    : enum_(en)
+{
+}
+
+size_t enumerating_filler::choose(std::vector<Value*> const& generated)
+{
+  return enum_.choose(generated.size());
+}
+
+} // namespace presyn
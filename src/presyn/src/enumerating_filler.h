@@ -0,0 +1,106 @@
+#pragma once
+
+#include "rule_filler.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace presyn {
+
+/**
+ * Systematic enumeration of the candidates that can be built from a sketch,
+ * as an alternative to sampling them at random.
+ *
+ * When filling a sketch, the rule filler makes one choice per hole from the
+ * values its rules generate. A candidate is therefore identified by the
+ * sequence of choice indices made while it was built. This sequence can be
+ * replayed to rebuild the same candidate, as long as candidate construction is
+ * otherwise deterministic. The enumeration walks these sequences in
+ * lexicographic order (depth-first over the tree of choices). Generated values
+ * are ordered by rule, and then by the order in which the filler collects its
+ * pool: values from dominating blocks (nearest block first), then earlier
+ * values in the hole's own block (nearest first), then parameters and
+ * constants. Values from the hole's own block therefore come after those from
+ * the blocks that dominate it.
+ *
+ * Only the first max_depth choices of each candidate are enumerated; later
+ * holes always take their first option, which keeps the space finite.
+ *
+ * The space can be split into disjoint shards for parallel workers. Candidates
+ * are grouped by their first split_depth choices, and each group is assigned
+ * to a shard by a hash of those choices (so that a resumed enumeration assigns
+ * groups in the same way). Every worker still builds the first candidate of
+ * each group to discover where the next group starts, but only tests (and
+ * descends into) the groups it owns.
+ *
+ * The cursor (the choices to replay for the next candidate) can be saved and
+ * passed back in to resume an enumeration.
+ */
+class enumeration {
+public:
+  explicit enumeration(
+      size_t max_depth, size_t shard = 0, size_t num_shards = 1,
+      size_t split_depth = 1, std::vector<size_t> cursor = {});
+
+  /**
+   * Create a filler that builds the candidate at the current cursor. Each
+   * filler must be used to build exactly one candidate, followed by a call to
+   * advance().
+   */
+  std::unique_ptr<filler> make_filler();
+
+  /**
+   * Record the choice made at the next hole of the candidate being built,
+   * given the number of options available there, and return it.
+   */
+  size_t choose(size_t arity);
+
+  /**
+   * Move the cursor past the candidate that was just built. Returns true if
+   * that candidate belongs to this shard and should be tested.
+   */
+  bool advance();
+
+  /**
+   * True once every candidate in the (bounded) space has been built.
+   */
+  bool done() const;
+
+  std::vector<size_t> const& cursor() const;
+
+  /**
+   * The number of candidates built so far, including ones skipped because they
+   * belong to other shards.
+   */
+  size_t visited() const;
+
+private:
+  size_t max_depth_;
+  size_t shard_;
+  size_t num_shards_;
+  size_t split_depth_;
+
+  std::vector<size_t> cursor_;
+
+  // The choices made, and the number available, at each hole of the candidate
+  // currently being built.
+  std::vector<size_t> choices_;
+  std::vector<size_t> arities_;
+
+  size_t visited_;
+  bool done_;
+};
+
+class enumerating_filler : public rule_filler {
+public:
+  explicit enumerating_filler(enumeration&);
+
+protected:
+  size_t choose(std::vector<llvm::Value*> const& generated) override;
+
+private:
+  enumeration& enum_;
+};
+
+} // namespace presyn
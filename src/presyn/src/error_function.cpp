@@ -1,13 +1,83 @@
 #include "error_function.h"
 
 #include <support/assert.h>
+#include <support/bit_cast.h>
+#include <support/float_compare.h>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 using namespace support;
 
 namespace presyn {
 
+namespace {
+
+constexpr auto max_error = int64_t {std::numeric_limits<int>::max()};
+
+int64_t element_distance(int64_t a, int64_t b)
+{
+  // Computed unsigned so that the difference can't overflow.
+  auto diff = a > b ? static_cast<uint64_t>(a) - static_cast<uint64_t>(b)
+                    : static_cast<uint64_t>(b) - static_cast<uint64_t>(a);
+  return static_cast<int64_t>(std::min<uint64_t>(diff, max_error));
+}
+
+int64_t element_distance(float a, float b)
+{
+  if (std::isnan(a) || std::isnan(b)) {
+    return (std::isnan(a) && std::isnan(b)) ? 0 : max_error;
+  }
+
+  auto tol = float_tolerance {};
+  if (ulp_equal(a, b, tol.max_ulps) || std::abs(a - b) <= tol.max_abs) {
+    return 0;
+  }
+
+  auto diff = std::ceil(std::abs(double(a) - double(b)));
+  return std::clamp<int64_t>(
+      diff < double(max_error) ? int64_t(diff) : max_error, 1, max_error);
+}
+
+int64_t element_distance(char a, char b) { return a == b ? 0 : 1; }
+
+template <typename T>
+int64_t array_distance(llvm::ArrayRef<T> a, llvm::ArrayRef<T> b)
+{
+  if (a.size() != b.size()) {
+    return max_error;
+  }
+
+  auto total = int64_t {0};
+  for (auto i = 0u; i < a.size() && total < max_error; ++i) {
+    total += element_distance(a[i], b[i]);
+  }
+
+  return std::min(total, max_error);
+}
+
+int64_t return_distance(props::data_type type, uint64_t a, uint64_t b)
+{
+  switch (type.base) {
+  case props::base_type::integer:
+    return element_distance(bit_cast<int64_t>(a), bit_cast<int64_t>(b));
+  case props::base_type::floating:
+    return element_distance(
+        bit_cast<float>(static_cast<uint32_t>(a)),
+        bit_cast<float>(static_cast<uint32_t>(b)));
+  case props::base_type::character:
+    return element_distance(
+        static_cast<char>(a & 0xFF), static_cast<char>(b & 0xFF));
+  case props::base_type::boolean:
+    return (a & 1) == (b & 1) ? 0 : 1;
+  }
+
+  invalid_state();
+}
+
+} // namespace
+
 int scalar_distance_error(
     output_example const& before, output_example const& after)
 {
@@ -28,4 +98,53 @@ int scalar_distance_error(
       static_cast<int64_t>(before.return_value - after.return_value));
 }
 
+int array_distance_error(
+    output_example const& before, output_example const& after)
+{
+  auto const& sig = before.output_args.signature();
+
+  assertion(
+      sig.compatible(after.output_args.signature()),
+      "Can't compute error function on argument packs with different "
+      "underlying signatures");
+
+  assertion(
+      before.output_args.scalar_args_equal(after.output_args),
+      "Can't compute array error if scalar arguments were different");
+
+  auto total = int64_t {0};
+
+  // Returned pointers are addresses, so there's nothing meaningful to compare.
+  if (sig.return_type && sig.return_type->pointers == 0) {
+    total += return_distance(
+        *sig.return_type, before.return_value, after.return_value);
+  }
+
+  for (auto i = 0u; i < sig.parameters.size() && total < max_error; ++i) {
+    auto const& param = sig.parameters[i];
+    if (param.pointer_depth == 0) {
+      continue;
+    }
+
+    auto const& b = before.output_args;
+    auto const& a = after.output_args;
+
+    switch (param.type) {
+    case props::base_type::integer:
+      total += array_distance(b.view<int64_t>(i), a.view<int64_t>(i));
+      break;
+    case props::base_type::floating:
+      total += array_distance(b.view<float>(i), a.view<float>(i));
+      break;
+    case props::base_type::character:
+      total += array_distance(b.view<char>(i), a.view<char>(i));
+      break;
+    default:
+      invalid_state();
+    }
+  }
+
+  return static_cast<int>(std::min(total, max_error));
+}
+
 } // namespace presyn
@@ -12,6 +12,22 @@ int scalar_distance_error(
     support::output_example const& before,
     support::output_example const& after);
 
+/**
+ * Distance between two outputs of a signature that may accept pointers: the
+ * distance between the return values (interpreted using the signature's return
+ * type), plus the sum of the element-wise distances between each pointer
+ * argument's data after the call.
+ *
+ * Integers are compared by absolute difference, and floats by absolute
+ * difference rounded up (with values inside the usual comparison tolerance
+ * counting as equal, so that any mismatch counts for at least 1). Characters
+ * count 1 per mismatch. The total saturates rather than overflowing, and NaN
+ * mismatches or differently-sized arrays count as the maximum error.
+ */
+int array_distance_error(
+    support::output_example const& before,
+    support::output_example const& after);
+
 template <typename ErrF>
 int compute_error(
     ErrF&& err, support::call_builder args, support::call_wrapper& f1,
@@ -1,6 +1,6 @@
 #include "optimiser.h"
 
-#include <llvm/IR/Dominators.h>
+#include "dominance_index.h"
 
 #include <support/assert.h>
 
@@ -56,18 +56,13 @@ void optimiser::rauw_nt_proxy(Instruction* before, Instruction* after)
 
 void optimiser::compute_initial_live_sets(Function* target)
 {
-  auto dom_tree = DominatorTree(*target);
+  auto index = dominance_index(*target);
 
-  // TODO: Naive implementation - fix later
   for (auto& from_i : provider_.holes()) {
-    live_values_.try_emplace(from_i);
+    auto& live = live_values_[from_i];
 
-    for (auto& to_bb : *target) {
-      for (auto& to_i : to_bb) {
-        if (dom_tree.dominates(&to_i, from_i)) {
-          live_values_[from_i].insert(&to_i);
-        }
-      }
+    for (auto val : index.live(from_i)) {
+      live.insert(cast<Instruction>(val));
     }
   }
 }
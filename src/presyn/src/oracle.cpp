@@ -1,4 +1,7 @@
+#include "annealing_filler.h"
 #include "candidate.h"
+#include "enumerating_filler.h"
+#include "error_function.h"
 #include "fragment.h"
 #include "oracle_options.h"
 #include "rule_filler.h"
@@ -11,9 +14,13 @@
 #include <support/call_builder.h>
 #include <support/call_wrapper.h>
 #include <support/dynamic_library.h>
+#include <support/example_set.h>
+#include <support/fingerprint.h>
 #include <support/input.h>
 #include <support/llvm_cloning.h>
 #include <support/llvm_format.h>
+#include <support/random.h>
+#include <support/sandbox.h>
 #include <support/terminal.h>
 #include <support/thread_context.h>
 
@@ -22,7 +29,14 @@
 
 #include <fmt/format.h>
 
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace support;
 using namespace presyn;
@@ -94,27 +108,201 @@ std::unique_ptr<fragment> get_fragment()
   return current_frag;
 }
 
-bool test(call_wrapper& a, call_wrapper& b)
+// Compute the expected outputs for a fixed set of random inputs once, up
+// front, so that candidates only need to be compared against stored results
+// rather than re-running the reference implementation every time. Examples
+// recorded by io-dump can be loaded instead of being generated.
+example_set make_examples(
+    props::signature const& sig, dynamic_library const& lib)
 {
-  auto gen = uniform_generator();
+  if (!opts::ExamplesPath.empty()) {
+    auto file = example_reader(opts::ExamplesPath);
+    if (file.signature() != sig) {
+      throw std::runtime_error(fmt::format(
+          "Recorded examples have signature {}, expected {}", file.signature(),
+          sig));
+    }
+
+    auto examples = example_set(sig);
+    examples.load(file);
+    return examples;
+  }
+
+  auto module = Module("oracle", thread_context::get());
+  auto ref_impl = call_wrapper(sig, module, sig.name, lib);
+
+  auto examples = example_set(sig);
+  examples.generate(ref_impl, uniform_generator(), 64);
+  return examples;
+}
+
+// The total error of a candidate over the examples, or nothing if it crashed
+// or timed out when sandboxed.
+std::optional<int64_t> score(
+    candidate& cand, example_set& examples,
+    example_set::error_function const& err)
+{
+  auto cand_impl = call_wrapper(cand.function());
+
+  if (opts::Sandbox) {
+    auto box = sandbox(cand_impl, std::chrono::milliseconds(opts::Timeout));
+    return examples.error(box, err);
+  }
+
+  return examples.error(cand_impl, err);
+}
+
+// Whether a candidate produces exactly the expected output for every example.
+bool passes(candidate& cand, example_set& examples)
+{
+  auto cand_impl = call_wrapper(cand.function());
+
+  if (opts::Sandbox) {
+    auto box = sandbox(cand_impl, std::chrono::milliseconds(opts::Timeout));
+    return examples.check(box);
+  }
+
+  return examples.check(cand_impl);
+}
+
+// Repeatedly generate and test candidates until one passes, or until another
+// worker signals that it has found a solution. Everything LLVM-related is
+// created on the calling thread so that workers don't share contexts or JIT
+// sessions, and each worker gets its own copy of the examples so that their
+// replay orders can evolve independently.
+//
+// The sketch is compiled once per worker; each candidate then starts from a
+// clone of it rather than recompiling the fragment.
+//
+// When enumerating, each worker only tests the candidates in its own shard of
+// the space, and gives up once its shard is exhausted. Candidates that are
+// structurally identical to one already tested (by any worker) are skipped
+// without being compiled.
+//
+// A guided search instead scores every candidate by how far its outputs are
+// from the expected ones, and builds the next candidate by changing one hole
+// of a recent good one. Revisiting a candidate is common (and needs its score
+// again), so each worker remembers scores by fingerprint instead of using the
+// shared cache to skip duplicates.
+std::optional<std::string> search(
+    props::signature const& sig, fragment const& frag, example_set examples,
+    fingerprint_cache& seen, std::atomic<bool>& done, unsigned shard = 0,
+    unsigned shards = 1)
+{
+  auto templ = sketch(sig, frag);
+
+  auto en = std::optional<enumeration> {};
+  if (opts::Enumerate) {
+    en.emplace(opts::MaxDepth, shard, shards, opts::SplitDepth);
+  }
+
+  auto an = std::optional<annealing> {};
+  if (opts::Guided) {
+    auto an_opts = annealing::options {};
+    an_opts.patience = opts::Patience;
+    an.emplace(an_opts);
+  }
+
+  auto make_filler = [&en, &an]() -> std::unique_ptr<filler> {
+    if (en) {
+      return en->make_filler();
+    }
+
+    if (an) {
+      return an->make_filler();
+    }
 
-  for (auto i = 0; i < 64; ++i) {
-    auto build = a.get_builder();
+    return std::make_unique<rule_filler>();
+  };
 
-    gen.gen_args(build);
+  auto scores = std::unordered_map<uint64_t, std::optional<int64_t>> {};
 
-    auto a_bef = build;
-    auto b_bef = build;
+  while (!done && !(en && en->done())) {
+    auto cand = candidate(templ.clone(), make_filler());
+    if (en && !en->advance()) {
+      continue;
+    }
+
+    assertion(cand.is_valid(), "Reification produced an invalid candidate");
+
+    auto passed = false;
+    if (an) {
+      auto fp = fingerprint(cand.function());
+      auto [it, fresh] = scores.try_emplace(fp);
+      if (fresh) {
+        it->second = score(cand, examples, array_distance_error);
+
+        // The error function allows for float tolerance and ignores returned
+        // pointers, so a zero score still needs to pass the exact check. One
+        // that doesn't is close, but not a solution.
+        if (it->second == 0 && !passes(cand, examples)) {
+          it->second = 1;
+        }
+      }
+
+      an->score(it->second);
+      passed = (it->second == 0);
+    } else {
+      if (!seen.insert(cand.function())) {
+        continue;
+      }
+
+      passed = passes(cand, examples);
+    }
+
+    if (passed) {
+      // Only the first worker to succeed gets to report its result.
+      if (!done.exchange(true)) {
+        return fmt::format("{}", cand.module());
+      }
+    }
+  }
+
+  return std::nullopt;
+}
+
+std::optional<std::string> parallel_search(
+    props::signature const& sig, fragment const& frag,
+    example_set const& examples, fingerprint_cache& seen, unsigned jobs)
+{
+  auto done = std::atomic<bool>(false);
+
+  auto results = std::vector<std::optional<std::string>>(jobs);
+  auto errors = std::vector<std::exception_ptr>(jobs);
+  auto workers = std::vector<std::thread> {};
+
+  for (auto i = 0u; i < jobs; ++i) {
+    workers.emplace_back([&, i] {
+      // Threads would otherwise be assigned random streams in whatever order
+      // they start up, which isn't reproducible.
+      use_random_stream(i);
+
+      try {
+        results[i] = search(sig, frag, examples, seen, done, i, jobs);
+      } catch (...) {
+        errors[i] = std::current_exception();
+        done = true;
+      }
+    });
+  }
 
-    auto a_res = a.call(build);
-    auto b_res = b.call(build);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (auto const& err : errors) {
+    if (err) {
+      std::rethrow_exception(err);
+    }
+  }
 
-    if (a_res != b_res) {
-      return false;
+  for (auto const& res : results) {
+    if (res) {
+      return res;
     }
   }
 
-  return true;
+  return std::nullopt;
 }
 
 int main(int argc, char** argv)
@@ -125,24 +313,32 @@ try {
 
   cl::ParseCommandLineOptions(argc, argv);
 
+  if (opts::Enumerate && opts::Guided) {
+    throw std::runtime_error("Can't use -enumerate and -guided together");
+  }
+
+  if (opts::Seed.getNumOccurrences() > 0) {
+    set_random_seed(opts::Seed);
+  }
+
   auto sig = get_sig();
   auto frag = get_fragment();
 
   auto lib = dynamic_library(opts::SharedLibrary);
-  auto module = Module("oracle", thread_context::get());
-  auto ref_impl = call_wrapper(sig, module, sig.name, lib);
+  auto examples = make_examples(sig, lib);
 
-  while (true) {
-    auto cand = candidate(sketch(sig, *frag), std::make_unique<rule_filler>());
-    assertion(cand.is_valid(), "Reification produced an invalid candidate");
+  auto seen = fingerprint_cache();
+  auto done = std::atomic<bool>(false);
+  auto result = (opts::Jobs > 1)
+                    ? parallel_search(sig, *frag, examples, seen, opts::Jobs)
+                    : search(sig, *frag, examples, seen, done);
 
-    auto cand_impl = call_wrapper(cand.function());
-
-    if (test(ref_impl, cand_impl)) {
-      fmt::print("{}\n", cand.module());
-      return 0;
-    }
+  if (result) {
+    fmt::print("{}\n", *result);
+    return 0;
   }
+
+  return 1;
 } catch (std::runtime_error& e) {
   fmt::print(
       stderr,
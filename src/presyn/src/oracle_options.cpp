@@ -12,4 +12,65 @@ cl::opt<std::string> SharedLibrary(
     cl::Positional, cl::desc("Shared library containing reference symbol"),
     cl::value_desc("<shared library>"), cl::Required);
 
+cl::opt<unsigned> Jobs(
+    "j", cl::desc("Number of worker threads to search for candidates with"),
+    cl::value_desc("threads"), cl::init(1));
+
+cl::opt<bool> Sandbox(
+    "sandbox",
+    cl::desc("Run candidates in a separate process so that crashes and "
+             "non-terminating candidates don't end the search"),
+    cl::init(false));
+
+cl::opt<unsigned> Timeout(
+    "timeout",
+    cl::desc("Time limit for each sandboxed call to a candidate, in "
+             "milliseconds"),
+    cl::value_desc("ms"), cl::init(1000));
+
+cl::opt<unsigned> Seed(
+    "seed",
+    cl::desc("Seed for example generation and candidate sampling, so that "
+             "searches are reproducible (with -j, each worker gets its own "
+             "stream derived from the seed)"),
+    cl::value_desc("seed"));
+
+cl::opt<std::string> ExamplesPath(
+    "examples",
+    cl::desc("Load recorded examples (as written by io-dump -o) instead of "
+             "generating new ones from the reference implementation"),
+    cl::value_desc("filename"));
+
+cl::opt<bool> Enumerate(
+    "enumerate",
+    cl::desc("Enumerate candidates systematically rather than sampling them, "
+             "stopping once every candidate has been tried (with -j, workers "
+             "search disjoint parts of the space)"),
+    cl::init(false));
+
+cl::opt<unsigned> MaxDepth(
+    "max-depth",
+    cl::desc("Number of holes per candidate whose choices are enumerated; "
+             "later holes always take their first choice"),
+    cl::value_desc("holes"), cl::init(8));
+
+cl::opt<unsigned> SplitDepth(
+    "split-depth",
+    cl::desc("Number of leading choices used to divide enumerated candidates "
+             "between workers"),
+    cl::value_desc("holes"), cl::init(2));
+
+cl::opt<bool> Guided(
+    "guided",
+    cl::desc("Search by refining candidates that are close to passing the "
+             "examples (using simulated annealing) rather than sampling each "
+             "one independently"),
+    cl::init(false));
+
+cl::opt<unsigned> Patience(
+    "patience",
+    cl::desc("Number of guided search steps without improvement before "
+             "restarting from a new random candidate"),
+    cl::value_desc("steps"), cl::init(64));
+
 } // namespace presyn::oracle::opts
@@ -8,5 +8,17 @@ namespace presyn::oracle::opts {
 
 extern llvm::cl::opt<std::string> InputFilename;
 extern llvm::cl::opt<std::string> SharedLibrary;
+extern llvm::cl::opt<unsigned> Jobs;
+extern llvm::cl::opt<bool> Sandbox;
+extern llvm::cl::opt<unsigned> Timeout;
+extern llvm::cl::opt<unsigned> Seed;
+extern llvm::cl::opt<std::string> ExamplesPath;
+
+extern llvm::cl::opt<bool> Enumerate;
+extern llvm::cl::opt<unsigned> MaxDepth;
+extern llvm::cl::opt<unsigned> SplitDepth;
+
+extern llvm::cl::opt<bool> Guided;
+extern llvm::cl::opt<unsigned> Patience;
 
 } // namespace presyn::oracle::opts
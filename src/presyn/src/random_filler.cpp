@@ -1,5 +1,7 @@
 #include "random_filler.h"
 
+#include "candidate.h"
+
 #include <support/assert.h>
 #include <support/llvm_format.h>
 
@@ -20,28 +22,7 @@ Value* random_filler::fill(CallInst* hole)
 
 std::vector<Value*> random_filler::live_values(CallInst* hole) const
 {
-  auto tree = tree_for(hole);
-  auto func = hole->getFunction();
-
-  auto ret = std::vector<Value*> {};
-
-  for (auto& bb : *func) {
-    for (auto& inst : bb) {
-      if (tree.dominates(&inst, hole)) {
-        ret.push_back(&inst);
-      }
-    }
-  }
-
-  return ret;
-}
-
-DominatorTree random_filler::tree_for(CallInst* hole) const
-{
-  auto func = hole->getFunction();
-  assertion(func != nullptr, "Hole does not have a function: {}", *hole);
-
-  return DominatorTree(*func);
+  return get_candidate().dominance().live(hole);
 }
 
 } // namespace presyn
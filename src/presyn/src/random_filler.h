@@ -2,9 +2,8 @@
 
 #include "filler.h"
 
-#include <llvm/IR/Dominators.h>
+#include <llvm/IR/Instructions.h>
 
-#include <map>
 #include <vector>
 
 namespace presyn {
@@ -18,8 +17,6 @@ protected:
 
 private:
   std::vector<llvm::Value*> live_values(llvm::CallInst*) const;
-
-  llvm::DominatorTree tree_for(llvm::CallInst*) const;
 };
 
 } // namespace presyn
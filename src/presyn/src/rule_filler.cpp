@@ -1,5 +1,6 @@
 #include "rule_filler.h"
 
+#include "candidate.h"
 #include "constants.h"
 #include "rules.h"
 
@@ -9,8 +10,6 @@
 #include <support/tuple.h>
 #include <support/utility.h>
 
-#include <llvm/IR/Dominators.h>
-
 #include <algorithm>
 
 using namespace support;
@@ -99,9 +98,8 @@ Value* rule_filler::fill(CallInst* hole)
     }
   });
 
-  auto chosen = uniform_sample(generated);
-  assertion(
-      chosen != generated.end(), "Failed to sample anything in rule filler");
+  assertion(!generated.empty(), "Failed to sample anything in rule filler");
+  auto chosen = generated.begin() + choose(generated);
 
   for (auto val : generated) {
     if (auto inst = dyn_cast<Instruction>(val)) {
@@ -114,29 +112,15 @@ Value* rule_filler::fill(CallInst* hole)
   return *chosen;
 }
 
-std::vector<llvm::Value*> rule_filler::collect_safe(llvm::CallInst* hole) const
+size_t rule_filler::choose(std::vector<llvm::Value*> const& generated)
 {
-  auto ret = std::vector<Value*> {};
-
-  auto func = hole->getFunction();
-  assertion(func, "Hole does not have an enclosing function");
-
-  auto this_bb = hole->getParent();
-  assertion(this_bb, "Hole does not have an enclosing BB");
-
-  auto tree = DominatorTree(*func);
-
-  for (auto& bb : *func) {
-    if (&bb != this_bb) {
-      for (auto& inst : bb) {
-        if (tree.dominates(&inst, hole)) {
-          ret.push_back(&inst);
-        }
-      }
-    }
-  }
+  return random_int<size_t>(0, generated.size() - 1);
+}
 
-  return ret;
+std::vector<llvm::Value*> rule_filler::collect_safe(llvm::CallInst* hole) const
+{
+  assertion(hole->getParent(), "Hole does not have an enclosing BB");
+  return get_candidate().dominance().dominating(hole, pool_size_);
 }
 
 std::vector<Value*> rule_filler::collect_local(CallInst* hole) const
@@ -13,11 +13,17 @@ public:
 protected:
   llvm::Value* fill(llvm::CallInst*) override;
 
+  // Pick one of the values generated by matching rules for a hole, returning
+  // its index. By default this is a uniform random choice; subclasses can
+  // override it to search the space of choices differently.
+  virtual size_t choose(std::vector<llvm::Value*> const& generated);
+
 private:
   // Collect values from any blocks that dominate this one (i.e. walking
   // backwards in the dominance tree). This will collect us values that are safe
   // to use in the synthesis, but might not be as interesting as local ones once
-  // we incorporate weighting).
+  // we incorporate weighting). At most pool_size_ of the nearest values are
+  // collected, so the cost doesn't grow with the size of the function.
   std::vector<llvm::Value*> collect_safe(llvm::CallInst*) const;
 
   // Collect local values walking backwards from this hole (only in the same
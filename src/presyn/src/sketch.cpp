@@ -6,6 +6,7 @@
 
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 using namespace support;
 using namespace llvm;
@@ -15,7 +16,6 @@ namespace presyn {
 sketch::sketch(props::signature sig, fragment const& frag)
     : module_(std::make_unique<Module>("sketch", thread_context::get()))
     , ctx_(module(), sig)
-    , stubs_ {}
 {
   auto function = sig.create_function(module());
 
@@ -37,6 +37,21 @@ sketch::sketch(props::signature sig, std::unique_ptr<fragment> const& frag)
 {
 }
 
+sketch::sketch(std::unique_ptr<Module> mod, sketch_context ctx)
+    : module_(std::move(mod))
+    , ctx_(std::move(ctx))
+{
+}
+
+sketch sketch::clone() const
+{
+  auto v_map = ValueToValueMapTy {};
+  auto mod = CloneModule(*module_, v_map);
+  auto ctx = ctx_.clone_into(*mod, v_map);
+
+  return sketch(std::move(mod), std::move(ctx));
+}
+
 Module& sketch::module() { return *module_; }
 
 Module const& sketch::module() const { return *module_; }
@@ -9,7 +9,7 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 
-#include <map>
+#include <memory>
 
 namespace presyn {
 
@@ -32,6 +32,14 @@ public:
   sketch(props::signature sig, fragment const&);
   sketch(props::signature sig, std::unique_ptr<fragment> const&);
 
+  /**
+   * Compiling a sketch from its fragments is identical work every time, so
+   * callers that need many candidates from the same sketch should compile it
+   * once and clone it for each of them (candidates consume the sketch they're
+   * built from). Cloning copies the compiled module in the same LLVM context.
+   */
+  sketch clone() const;
+
   llvm::Module& module();
   llvm::Module const& module() const;
 
@@ -41,9 +49,9 @@ protected:
   sketch_context ctx_;
 
 private:
-  llvm::Value* create_return_stub(llvm::BasicBlock*);
+  sketch(std::unique_ptr<llvm::Module>, sketch_context);
 
-  std::map<llvm::Type*, llvm::Function*> stubs_;
+  llvm::Value* create_return_stub(llvm::BasicBlock*);
 };
 
 } // namespace presyn
@@ -16,13 +16,45 @@ using namespace llvm;
 namespace presyn {
 
 sketch_context::sketch_context(Module& mod, props::signature sig)
+    : sketch_context(
+        mod, sig,
+        PointerType::getUnqual(
+            StructType::create(thread_context::get(), "opaque")))
+{
+}
+
+sketch_context::sketch_context(
+    Module& mod, props::signature sig, Type* opaque_type)
     : module_(mod)
     , sig_(sig)
-    , opaque_type_(PointerType::getUnqual(
-          StructType::create(thread_context::get(), "opaque")))
+    , opaque_type_(opaque_type)
 {
 }
 
+sketch_context sketch_context::clone_into(
+    Module& mod, ValueToValueMapTy const& v_map) const
+{
+  auto ret = sketch_context(mod, sig_, opaque_type_);
+
+  auto mapped = [&v_map](Function* f) {
+    return cast<Function>(static_cast<Value*>(v_map.lookup(f)));
+  };
+
+  for (auto [ty, func] : stubs_) {
+    ret.stubs_[ty] = mapped(func);
+  }
+
+  for (auto const& [key, func] : ops_) {
+    ret.ops_[key] = mapped(func);
+  }
+
+  // Name constants are uniqued by the LLVM context rather than owned by the
+  // module, so they can be shared.
+  ret.names_ = names_;
+
+  return ret;
+}
+
 CallInst* sketch_context::stub() { return stub(opaque_type_); }
 
 CallInst* sketch_context::stub(llvm::Type* ty)
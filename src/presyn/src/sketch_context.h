@@ -6,6 +6,7 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
 
 #include <map>
 #include <string>
@@ -68,7 +69,17 @@ public:
 
   llvm::Type* opaque_type() const;
 
+  /**
+   * Create a context for a clone of this context's module, with its stubs and
+   * operations mapped to their copies in the clone. The clone shares this
+   * context's opaque type, as the cloned IR refers to it.
+   */
+  sketch_context
+  clone_into(llvm::Module&, llvm::ValueToValueMapTy const&) const;
+
 private:
+  sketch_context(llvm::Module&, props::signature, llvm::Type*);
+
   llvm::Constant* constant_name(std::string const&);
 
   llvm::Module& module_;
@@ -0,0 +1,116 @@
+#include <catch2/catch.hpp>
+
+#include "annealing_filler.h"
+
+#include <support/random.h>
+
+#include <cstdlib>
+#include <optional>
+#include <vector>
+
+using namespace presyn;
+using namespace support;
+
+namespace {
+
+// Stand-in for building a candidate: a fixed number of holes with 10 options
+// each.
+std::vector<size_t> build(annealing& an, size_t holes = 6)
+{
+  auto trace = std::vector<size_t> {};
+  for (auto i = 0u; i < holes; ++i) {
+    trace.push_back(an.choose(10));
+  }
+  return trace;
+}
+
+int64_t distance(std::vector<size_t> const& a, std::vector<size_t> const& b)
+{
+  auto total = int64_t {0};
+  for (auto i = 0u; i < a.size(); ++i) {
+    total += std::abs(int64_t(a[i]) - int64_t(b[i]));
+  }
+  return total;
+}
+
+} // namespace
+
+TEST_CASE("Annealing proposes neighbours of the current candidate")
+{
+  set_random_seed(1);
+
+  auto an = annealing();
+  auto first = build(an);
+  an.score(10);
+
+  for (auto i = 0; i < 10; ++i) {
+    auto next = build(an);
+    an.score(std::nullopt);
+
+    // Unscorable candidates are never accepted, so every proposal is one
+    // change away from the first candidate.
+    auto changed = 0;
+    for (auto j = 0u; j < first.size(); ++j) {
+      changed += (next[j] != first[j]);
+    }
+
+    REQUIRE(changed == 1);
+  }
+
+  REQUIRE(an.best() == 10);
+  REQUIRE(an.best_choices() == first);
+}
+
+TEST_CASE("Annealing finds a solution by following the score")
+{
+  set_random_seed(2);
+
+  auto target = std::vector<size_t> {3, 1, 4, 1, 5, 9};
+
+  auto an = annealing();
+  auto found = false;
+
+  // Blind sampling would need around 10^6 candidates here.
+  for (auto i = 0; i < 2000 && !found; ++i) {
+    auto score = distance(build(an), target);
+    an.score(score);
+    found = (score == 0);
+  }
+
+  REQUIRE(found);
+  REQUIRE(an.best() == 0);
+  REQUIRE(an.best_choices() == target);
+}
+
+TEST_CASE("Annealing restarts when it stops improving")
+{
+  set_random_seed(3);
+
+  auto opts = annealing::options {};
+  opts.patience = 4;
+
+  auto an = annealing(opts);
+
+  build(an);
+  an.score(0);
+
+  // After a restart, the first score counts as an improvement again.
+  for (auto i = 0; i < 16; ++i) {
+    build(an);
+    an.score(1);
+  }
+
+  REQUIRE(an.steps() == 17);
+  REQUIRE(an.restarts() == 2);
+  REQUIRE(an.best() == 0);
+}
+
+TEST_CASE("Annealing restarts when nothing can be changed")
+{
+  auto an = annealing();
+
+  an.choose(1);
+  an.score(5);
+
+  REQUIRE(an.restarts() == 1);
+}
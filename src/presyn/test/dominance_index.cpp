@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+
+#include "dominance_index.h"
+
+#include <support/thread_context.h>
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
+
+#include <algorithm>
+
+using namespace support;
+using namespace presyn;
+using namespace llvm;
+
+namespace {
+
+bool contains(std::vector<Value*> const& vals, Value* v)
+{
+  return std::find(vals.begin(), vals.end(), v) != vals.end();
+}
+
+} // namespace
+
+TEST_CASE("Dominance index finds values available at each point")
+{
+  auto& ctx = thread_context::get();
+  auto mod = Module("test", ctx);
+
+  auto i64 = IntegerType::get(ctx, 64);
+  auto fn_ty = FunctionType::get(i64, {i64}, false);
+  auto fn = Function::Create(fn_ty, GlobalValue::ExternalLinkage, "f", mod);
+  auto arg = fn->getArg(0);
+
+  auto entry = BasicBlock::Create(ctx, "entry", fn);
+  auto left = BasicBlock::Create(ctx, "left", fn);
+  auto right = BasicBlock::Create(ctx, "right", fn);
+  auto join = BasicBlock::Create(ctx, "join", fn);
+
+  auto build = IRBuilder(entry);
+
+  // Every add has a non-constant operand, so the builder never folds them away.
+  auto add = [&](Value* lhs, int64_t rhs, char const* name) {
+    return cast<Instruction>(
+        build.CreateAdd(lhs, ConstantInt::get(i64, rhs), name));
+  };
+
+  auto a = add(arg, 1, "a");
+  auto a2 = add(a, 1, "a2");
+  auto cond = cast<Instruction>(
+      build.CreateICmpSLT(a2, ConstantInt::get(i64, 0), "cond"));
+  build.CreateCondBr(cond, left, right);
+
+  build.SetInsertPoint(left);
+  auto b = add(a, 2, "b");
+  auto b2 = add(b, 2, "b2");
+  build.CreateBr(join);
+
+  build.SetInsertPoint(right);
+  auto c = add(a, 3, "c");
+  build.CreateBr(join);
+
+  build.SetInsertPoint(join);
+  auto d = add(a2, 4, "d");
+  auto ret = build.CreateRet(d);
+
+  auto index = dominance_index(*fn);
+
+  SECTION("Values from dominating blocks")
+  {
+    auto at_join = index.dominating(d);
+    REQUIRE(at_join == std::vector<Value*> {cond, a2, a});
+
+    auto at_left = index.dominating(b2);
+    REQUIRE(!contains(at_left, b));
+    REQUIRE(contains(at_left, a));
+    REQUIRE(!contains(at_left, c));
+  }
+
+  SECTION("Live values include the local block")
+  {
+    auto live = index.live(ret);
+    REQUIRE(live == std::vector<Value*> {d, cond, a2, a});
+
+    REQUIRE(index.live(b2) == std::vector<Value*> {b, cond, a2, a});
+  }
+
+  SECTION("Queries can be limited")
+  {
+    REQUIRE(index.live(ret, 2) == std::vector<Value*> {d, cond});
+    REQUIRE(index.dominating(c, 1) == std::vector<Value*> {cond});
+  }
+
+  SECTION("Queries see instructions inserted after indexing")
+  {
+    build.SetInsertPoint(d);
+    auto e = cast<Instruction>(build.CreateAdd(a, a, "e"));
+
+    REQUIRE(index.live(d).front() == e);
+    REQUIRE(!contains(index.live(e), e));
+  }
+}
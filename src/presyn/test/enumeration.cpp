@@ -0,0 +1,161 @@
+#include <catch2/catch.hpp>
+
+#include "enumerating_filler.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace presyn;
+
+namespace {
+
+// Stand-in for building a candidate: a tree of choices where the number of
+// holes and the options at each one depend on the choices made earlier.
+std::vector<size_t> build(enumeration& en)
+{
+  auto trace = std::vector<size_t> {};
+
+  auto first = en.choose(3);
+  trace.push_back(first);
+
+  for (auto i = 0u; i < first; ++i) {
+    trace.push_back(en.choose(2 + i));
+  }
+
+  return trace;
+}
+
+std::vector<std::vector<size_t>> run(enumeration& en)
+{
+  auto ret = std::vector<std::vector<size_t>> {};
+
+  while (!en.done()) {
+    auto trace = build(en);
+    if (en.advance()) {
+      ret.push_back(trace);
+    }
+  }
+
+  return ret;
+}
+
+} // namespace
+
+TEST_CASE("Enumeration visits every candidate once, in order")
+{
+  auto en = enumeration(8);
+  auto all = run(en);
+
+  // 1 + 2 + 2 * 3 candidates in total.
+  REQUIRE(all.size() == 9);
+  REQUIRE(en.visited() == 9);
+  REQUIRE(std::is_sorted(all.begin(), all.end()));
+  REQUIRE(std::set(all.begin(), all.end()).size() == all.size());
+
+  REQUIRE(all.front() == std::vector<size_t> {0});
+  REQUIRE(all.back() == std::vector<size_t> {2, 1, 2});
+}
+
+TEST_CASE("Enumeration depth can be bounded")
+{
+  auto en = enumeration(2);
+  auto all = run(en);
+
+  // The third hole always takes its first option.
+  REQUIRE(all.size() == 5);
+  for (auto const& trace : all) {
+    if (trace.size() > 2) {
+      REQUIRE(trace[2] == 0);
+    }
+  }
+}
+
+TEST_CASE("Enumeration shards are disjoint and cover the space")
+{
+  auto full = enumeration(8);
+  auto all = run(full);
+
+  for (auto split = 0u; split < 3; ++split) {
+    for (auto shards = 1u; shards < 5; ++shards) {
+      auto seen = std::vector<std::vector<size_t>> {};
+
+      for (auto i = 0u; i < shards; ++i) {
+        auto en = enumeration(8, i, shards, split);
+        auto part = run(en);
+        seen.insert(seen.end(), part.begin(), part.end());
+      }
+
+      std::sort(seen.begin(), seen.end());
+      REQUIRE(seen == all);
+    }
+  }
+}
+
+TEST_CASE("Enumerations can be resumed from a cursor")
+{
+  auto full = enumeration(8);
+  auto all = run(full);
+
+  auto en = enumeration(8);
+  for (auto i = 0; i < 4; ++i) {
+    build(en);
+    en.advance();
+  }
+
+  auto resumed = enumeration(8, 0, 1, 1, en.cursor());
+  auto rest = run(resumed);
+
+  REQUIRE(rest == std::vector(all.begin() + 4, all.end()));
+}
+
+TEST_CASE("Sharded enumerations can be resumed from a cursor")
+{
+  auto full = enumeration(8);
+  auto all = run(full);
+
+  for (auto split = 1u; split < 3; ++split) {
+    for (auto shards = 2u; shards < 5; ++shards) {
+      // Resuming every shard from the same point covers the rest of the space
+      // without overlap.
+      auto start = enumeration(8);
+      for (auto i = 0; i < 4; ++i) {
+        build(start);
+        start.advance();
+      }
+
+      auto seen = std::vector<std::vector<size_t>> {};
+
+      for (auto i = 0u; i < shards; ++i) {
+        auto en = enumeration(8, i, shards, split, start.cursor());
+        auto part = run(en);
+        seen.insert(seen.end(), part.begin(), part.end());
+
+        // A shard interrupted and resumed tests the same candidates as one
+        // that runs straight through.
+        auto straight = enumeration(8, i, shards, split);
+        auto expected = run(straight);
+
+        auto first = enumeration(8, i, shards, split);
+        auto tested = std::vector<std::vector<size_t>> {};
+        for (auto j = 0; j < 3 && !first.done(); ++j) {
+          auto trace = build(first);
+          if (first.advance()) {
+            tested.push_back(trace);
+          }
+        }
+
+        if (!first.done()) {
+          auto second = enumeration(8, i, shards, split, first.cursor());
+          auto rest = run(second);
+          tested.insert(tested.end(), rest.begin(), rest.end());
+        }
+
+        REQUIRE(tested == expected);
+      }
+
+      std::sort(seen.begin(), seen.end());
+      REQUIRE(seen == std::vector(all.begin() + 4, all.end()));
+    }
+  }
+}
@@ -10,6 +10,10 @@
 
 #include <llvm/IR/Module.h>
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
 using namespace support;
 using namespace presyn;
 using namespace props;
@@ -65,3 +69,57 @@ TEST_CASE("Can properly compute errors from wrappers")
     REQUIRE(e2 == 0);
   }
 }
+
+TEST_CASE("Array distance sums element-wise differences")
+{
+  SECTION("For integer arrays")
+  {
+    auto sig = "int f(int *xs, int n)"_sig;
+
+    auto b1 = call_builder(sig, std::vector<int64_t> {1, 2, 3}, 3);
+    auto b2 = call_builder(sig, std::vector<int64_t> {1, 5, -1}, 3);
+
+    REQUIRE(array_distance_error({2, b1}, {2, b1}) == 0);
+    REQUIRE(array_distance_error({2, b1}, {2, b2}) == 7);
+    REQUIRE(array_distance_error({2, b1}, {4, b2}) == 9);
+  }
+
+  SECTION("For float arrays")
+  {
+    auto sig = "void f(float *xs)"_sig;
+
+    auto b1 = call_builder(sig, std::vector<float> {1.0f, 2.0f});
+    auto b2 = call_builder(sig, std::vector<float> {1.0001f, 2.5f});
+    auto b3 = call_builder(sig, std::vector<float> {1.0f, std::nanf("")});
+
+    REQUIRE(array_distance_error({0, b1}, {0, b2}) == 1);
+    REQUIRE(
+        array_distance_error({0, b1}, {0, b3})
+        == std::numeric_limits<int>::max());
+  }
+
+  SECTION("For character arrays")
+  {
+    auto sig = "void f(char *s)"_sig;
+
+    auto b1 = call_builder(sig, std::vector<char> {'a', 'b', 'c'});
+    auto b2 = call_builder(sig, std::vector<char> {'a', 'x', 'y'});
+
+    REQUIRE(array_distance_error({0, b1}, {0, b2}) == 2);
+  }
+}
+
+TEST_CASE("Array distance saturates instead of overflowing")
+{
+  auto sig = "int f(int *xs)"_sig;
+
+  auto max = std::numeric_limits<int64_t>::max();
+  auto min = std::numeric_limits<int64_t>::min();
+
+  auto b1 = call_builder(sig, std::vector<int64_t> {max, max});
+  auto b2 = call_builder(sig, std::vector<int64_t> {min, min});
+
+  REQUIRE(
+      array_distance_error({0, b1}, {0, b2})
+      == std::numeric_limits<int>::max());
+}
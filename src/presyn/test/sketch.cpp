@@ -0,0 +1,97 @@
+#include <catch2/catch.hpp>
+
+#include "candidate.h"
+#include "fragment.h"
+#include "rule_filler.h"
+#include "sketch.h"
+#include "sketch_context.h"
+
+#include <props/props.h>
+
+#include <support/thread_context.h>
+
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include <memory>
+
+using namespace support;
+using namespace presyn;
+using namespace props::literals;
+using namespace llvm;
+
+namespace {
+
+// Contexts hand back unparented calls; only the callee is of interest here.
+Function* callee(CallInst* call)
+{
+  auto func = call->getCalledFunction();
+  call->deleteValue();
+  return func;
+}
+
+} // namespace
+
+TEST_CASE("Cloned sketch contexts refer to the cloned module")
+{
+  auto mod = Module("test", thread_context::get());
+  auto ctx = sketch_context(mod, "int f(int x)"_sig);
+
+  auto i64 = IntegerType::get(thread_context::get(), 64);
+
+  auto stub = callee(ctx.stub(i64));
+  auto opaque_stub = callee(ctx.stub());
+  auto op = callee(ctx.operation("load", i64, {}));
+  auto opaque_op = callee(ctx.operation("store", {}));
+
+  auto v_map = ValueToValueMapTy {};
+  auto clone = CloneModule(mod, v_map);
+  auto cloned = ctx.clone_into(*clone, v_map);
+
+  REQUIRE(cloned.opaque_type() == ctx.opaque_type());
+
+  auto num_functions = clone->size();
+
+  // Existing stubs and operations are found in the clone rather than being
+  // created again.
+  for (auto [func, call] : {
+           std::pair {stub, cloned.stub(i64)},
+           std::pair {opaque_stub, cloned.stub()},
+           std::pair {op, cloned.operation("load", i64, {})},
+           std::pair {opaque_op, cloned.operation("store", {})},
+       }) {
+    auto cloned_func = callee(call);
+
+    REQUIRE(cloned_func->getParent() == clone.get());
+    REQUIRE(cloned_func == v_map.lookup(func));
+  }
+
+  REQUIRE(clone->size() == num_functions);
+
+  // The original context is unaffected.
+  REQUIRE(callee(ctx.stub(i64)) == stub);
+  REQUIRE(stub->getParent() == &mod);
+}
+
+TEST_CASE("Candidates can be built from cloned sketches")
+{
+  auto sig = "int f(int x, int *ys)"_sig;
+  auto frag = linear(2);
+
+  auto templ = sketch(sig, frag);
+
+  auto first = candidate(templ.clone(), std::make_unique<rule_filler>());
+  REQUIRE(first.is_valid());
+  REQUIRE(&first.module() != &templ.module());
+
+  auto second = candidate(templ.clone(), std::make_unique<rule_filler>());
+  REQUIRE(second.is_valid());
+  REQUIRE(first.ctx().opaque_type() == second.ctx().opaque_type());
+
+  // Cloning leaves the original sketch usable.
+  auto last = candidate(std::move(templ), std::make_unique<rule_filler>());
+  REQUIRE(last.is_valid());
+  REQUIRE(last.ctx().opaque_type() == first.ctx().opaque_type());
+}
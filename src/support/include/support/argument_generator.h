@@ -2,14 +2,20 @@
 
 #include <support/assert.h>
 #include <support/call_builder.h>
+#include <support/random.h>
 #include <support/traits.h>
 #include <support/utility.h>
 
 #include <props/props.h>
 
+#include <llvm/ADT/ArrayRef.h>
+
+#include <algorithm>
 #include <limits>
+#include <map>
 #include <memory>
 #include <random>
+#include <tuple>
 #include <type_traits>
 #include <unordered_map>
 
@@ -139,6 +145,21 @@ class override_generator;
  * This does generate integers as values in the range [0, max_size), which means
  * that they can be safely used to index into arrays generated by this
  * generator.
+ *
+ * Array arguments are large (max_size cubed elements), so filling them is
+ * usually the dominant cost of generating inputs. Values are drawn from a fast
+ * PRNG into storage owned by the generator and copied straight into the call
+ * builder, so no intermediate vectors are allocated. After a call to
+ * preallocate(), arrays are instead taken as randomly placed windows onto
+ * pools of values generated up front, so generating an input costs only the
+ * copy into the builder.
+ *
+ * When constructed from a property set, the generator uses its size
+ * properties (size ptr, n) and packing properties (pack ptr, k) to allocate
+ * exactly n * k elements for each sized pointer, given the value generated (or
+ * overridden) for n. Size parameters are generated as non-negative integers.
+ * Pointers without a size property still get the full cubed allocation, as
+ * nothing is known about how they are accessed.
  */
 class uniform_generator {
   template <typename Value>
@@ -155,9 +176,15 @@ public:
 
   uniform_generator();
   uniform_generator(size_t);
+  explicit uniform_generator(props::property_set const&, size_t = max_size);
 
-  void preallocate(size_t);
-  void reset();
+  /**
+   * Switch to drawing arrays from pre-generated pools, each holding enough
+   * values for n + 1 arrays. Larger pools give more variety between generated
+   * arrays at the cost of memory. The pools are regenerated if the bounds on
+   * generated values change.
+   */
+  void preallocate(size_t n);
 
   void seed(std::random_device::result_type);
   void gen_args(call_builder&);
@@ -169,23 +196,65 @@ protected:
   template <typename T>
   T gen_single();
 
+  /**
+   * Generate an array of values, returning a view onto storage owned by the
+   * generator. The view is invalidated by the next call to the generator.
+   */
   template <typename T>
-  std::vector<T> gen_array();
+  llvm::ArrayRef<T> gen_array();
+
+  template <typename T>
+  llvm::ArrayRef<T> gen_array(size_t len);
+
+  /**
+   * Generate a full set of arguments, using fixed values for any parameters
+   * named in overrides.
+   */
+  template <typename Value>
+  void gen_args(
+      call_builder&, std::unordered_map<std::string, Value> const& overrides);
 
 private:
+  using bounds = std::tuple<int, int, float, float>;
+
+  struct size_spec {
+    std::string size_param;
+    int64_t pack;
+  };
+
+  int64_t gen_size();
+
+  size_t array_length(
+      std::string const& ptr,
+      std::map<std::string, int64_t> const& size_values) const;
+
+  size_t array_size() const;
+  bounds current_bounds() const;
+
   template <typename T>
-  std::vector<T> gen_array_internal();
+  std::vector<T>& storage();
+
+  template <typename T>
+  void fill(std::vector<T>& data);
+
+  void fill_pools();
 
   std::default_random_engine engine_;
+  xoshiro256ss fast_engine_;
   size_t size_;
 
   bool reuse_;
+  size_t pool_arrays_;
+  bounds pool_bounds_;
 
-  std::vector<std::vector<int64_t>> int_arrays_;
-  std::vector<std::vector<float>> float_arrays_;
-  std::vector<std::vector<char>> char_arrays_;
+  // Keyed by pointer parameter name.
+  std::map<std::string, size_spec> sizes_;
 
-  int prealloc_idx_;
+  // Scratch space for a single array, or pools of pre-generated values if
+  // reuse_ is set.
+  std::vector<int64_t> int_data_;
+  std::vector<float> float_data_;
+  std::vector<char> char_data_;
 };
 
 /**
@@ -249,31 +318,135 @@ template <>
 float uniform_generator::gen_single<float>();
 
 template <typename T>
-std::vector<T> uniform_generator::gen_array()
+llvm::ArrayRef<T> uniform_generator::gen_array()
 {
-  if (reuse_) {
-    if constexpr (std::is_same_v<T, int64_t>) {
-      return int_arrays_.at(prealloc_idx_++);
-    } else if constexpr (std::is_same_v<T, float>) {
-      return float_arrays_.at(prealloc_idx_++);
-    } else if constexpr (std::is_same_v<T, char>) {
-      return char_arrays_.at(prealloc_idx_++);
-    } else {
-      invalid_state();
-    }
+  return gen_array<T>(array_size());
+}
+
+template <typename T>
+llvm::ArrayRef<T> uniform_generator::gen_array(size_t len)
+{
+  auto& data = storage<T>();
+
+  if (!reuse_) {
+    data.resize(len);
+    fill(data);
+    return data;
+  }
+
+  if (pool_bounds_ != current_bounds()) {
+    fill_pools();
+  }
+
+  // Overridden sizes can ask for more than the pool was built to hold.
+  if (data.size() < len) {
+    data.resize(len + array_size() * pool_arrays_);
+    fill(data);
+  }
+
+  auto offset = std::uniform_int_distribution<size_t>(
+      0, data.size() - len)(fast_engine_);
+  return llvm::ArrayRef<T>(data.data() + offset, len);
+}
+
+template <typename T>
+std::vector<T>& uniform_generator::storage()
+{
+  if constexpr (std::is_same_v<T, int64_t>) {
+    return int_data_;
+  } else if constexpr (std::is_same_v<T, float>) {
+    return float_data_;
+  } else if constexpr (std::is_same_v<T, char>) {
+    return char_data_;
   } else {
-    return gen_array_internal<T>();
+    static_assert(false_v<T>, "Unknown array element type");
   }
 }
 
 template <typename T>
-std::vector<T> uniform_generator::gen_array_internal()
+void uniform_generator::fill(std::vector<T>& data)
 {
-  // Cubing here to ensure that sizes are respected even if we're in the
-  // presence of (say) an O(n^3) algorithm.
-  auto ret = std::vector<T>(size_ * size_ * size_);
-  std::generate(ret.begin(), ret.end(), [this] { return gen_single<T>(); });
-  return ret;
+  if constexpr (std::is_same_v<T, int64_t>) {
+    assertion(
+        int_min <= int_max,
+        "Must set minimum int value below maximum (current interval: [{}, "
+        "{}])\n",
+        int_min, int_max);
+    fill_uniform(fast_engine_, data.data(), data.size(), int_min, int_max);
+  } else if constexpr (std::is_same_v<T, float>) {
+    assertion(
+        float_min <= float_max,
+        "Must set minimum float value below maximum (current interval: [{}, "
+        "{}])\n",
+        float_min, float_max);
+    fill_uniform(
+        fast_engine_, data.data(), data.size(), float_min, float_max);
+  } else {
+    fill_uniform(fast_engine_, data.data(), data.size());
+  }
+}
+
+template <typename Value>
+void uniform_generator::gen_args(
+    call_builder& build, std::unordered_map<std::string, Value> const& overrides)
+{
+  using namespace props;
+
+  auto const& params = build.signature().parameters;
+
+  auto is_size_param = [&](auto const& name) {
+    return std::any_of(params.begin(), params.end(), [&](auto const& p) {
+      return p.name == name && p.type == base_type::integer
+             && p.pointer_depth == 0;
+    });
+  };
+
+  // Sized arrays can appear before their size parameter in the signature, so
+  // the sizes need to be chosen before anything is added to the builder.
+  auto size_values = std::map<std::string, int64_t> {};
+
+  for (auto const& [ptr, spec] : sizes_) {
+    auto const& name = spec.size_param;
+
+    if (size_values.find(name) != size_values.end() || !is_size_param(name)) {
+      continue;
+    }
+
+    if (auto over = overrides.find(name); over != overrides.end()) {
+      size_values[name] = static_cast<int64_t>(over->second);
+    } else {
+      size_values[name] = gen_size();
+    }
+  }
+
+  for (auto const& p : params) {
+    if (auto over = overrides.find(p.name); over != overrides.end()) {
+      build.add(over->second);
+      continue;
+    }
+
+    if (p.pointer_depth == 0) {
+      if (auto sv = size_values.find(p.name); sv != size_values.end()) {
+        build.add(sv->second);
+      } else if (p.type == base_type::integer) {
+        build.add(gen_single<int64_t>());
+      } else if (p.type == base_type::character) {
+        build.add(gen_single<char>());
+      } else if (p.type == base_type::floating) {
+        build.add(gen_single<float>());
+      }
+    } else {
+      auto len = array_length(p.name, size_values);
+
+      if (p.type == base_type::integer) {
+        build.add(gen_array<int64_t>(len));
+      } else if (p.type == base_type::character) {
+        build.add(gen_array<char>(len));
+      } else if (p.type == base_type::floating) {
+        build.add(gen_array<float>(len));
+      }
+    }
+  }
 }
 
 template <typename Value>
@@ -283,7 +456,7 @@ override_generator<Value>::override_generator(
     : base_gen_(std::forward<Args>(args)...)
     , map_(map)
 {
-  base_gen_.preallocate(16);
+  base_gen_.preallocate(1);
 }
 
 template <typename Value>
@@ -305,42 +478,7 @@ void override_generator<Value>::set_value(std::string const& key, Value v)
 template <typename Value>
 void override_generator<Value>::gen_args(call_builder& build)
 {
-  using namespace props;
-
-  base_gen_.reset();
-
-  auto make_action = [&](auto&& action) {
-    return [&](auto const& p) {
-      auto any = false;
-
-      for (auto const& [key, value] : map_) {
-        if (p.name == key) {
-          build.add(value);
-          any = true;
-          break;
-        }
-      }
-
-      if (!any) {
-        action();
-      }
-    };
-  };
-
-  auto vis = sig_visitor {
-      on(base_type::integer,
-         make_action([&] { build.add(base_gen_.gen_single<int64_t>()); })),
-      on(base_type::character,
-         make_action([&] { build.add(base_gen_.gen_single<char>()); })),
-      on(base_type::floating,
-         make_action([&] { build.add(base_gen_.gen_single<float>()); })),
-      on(base_type::integer, 1,
-         make_action([&] { build.add(base_gen_.gen_array<int64_t>()); })),
-      on(base_type::character, 1,
-         make_action([&] { build.add(base_gen_.gen_array<char>()); })),
-      on(base_type::floating, 1,
-         make_action([&] { build.add(base_gen_.gen_array<float>()); }))};
-  vis.visit(build.signature());
+  base_gen_.gen_args(build, map_);
 }
 
 } // namespace support
@@ -5,11 +5,14 @@
 #include <support/assert.h>
 #include <support/traits.h>
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ExecutionEngine/GenericValue.h>
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace support {
@@ -66,12 +69,15 @@ public:
  *
  * Builders can accept integer and floating point scalar values, and vectors of
  * the same. Scalars are copied directly into the output array, while vector
- * data is handled by storing copies of passed vector arguments inside the
- * builder.
+ * data is copied into a single arena buffer owned by the builder, and recorded
+ * as an offset into that buffer.
  *
- * The reason for this is that the implementation functions inside call wrappers
- * accept pointers - an alternative design choice would be to copy data out into
- * a central vector, and store argument pointers as offsets into that vector.
+ * The implementation functions inside call wrappers accept pointers, so the
+ * pointer arguments in the output array are only materialised from their
+ * offsets when the raw argument data is requested. This means that copying a
+ * builder is just a copy of two flat byte buffers, with no per-array
+ * allocations or pointer fix-ups, and that assigning to an existing builder
+ * can reuse its storage rather than allocating.
  */
 class call_builder {
 public:
@@ -90,16 +96,20 @@ public:
   explicit call_builder(props::signature sig, Ts&&... args);
 
   /**
-   * Copy constructor and assignment using copy-and-swap. The copy constructor
-   * performs a deep copy of stored vectors, ensuring that the newly constructed
-   * builder has pointers into its own vectors.
+   * Copying a builder copies its argument bytes and arena directly. Because
+   * pointer arguments are stored as offsets until args() is called, no fix-up
+   * of the copied data is required. Copy assignment reuses the existing
+   * buffers of the destination where they are large enough, so a scratch
+   * builder can be repeatedly reset from a template pack without allocating.
    */
-  call_builder(call_builder const&);
-  call_builder& operator=(call_builder);
+  call_builder(call_builder const&) = default;
+  call_builder(call_builder&&) = default;
+  call_builder& operator=(call_builder const&) = default;
+  call_builder& operator=(call_builder&&) = default;
 
   /**
    * Destroy the currently accumulated arguments and return to the beginning of
-   * the building process.
+   * the building process. Allocated storage is kept for reuse.
    */
   void reset();
 
@@ -133,9 +143,9 @@ public:
   void add(int arg);
 
   /**
-   * Add a vector to the argument pack. Copies the vector into the builder's
-   * internal storage, then writes the raw bytes of the newly copied vector's
-   * data pointer into the argument pack. If the builder is not expecting a
+   * Add a vector to the argument pack. Copies the vector's data into the
+   * builder's arena, and reserves space in the argument pack for a pointer to
+   * it. If the builder is not expecting a
    * vector argument of the passed type, an exception is thrown.
    *
    * T must be int or float.
@@ -143,6 +153,14 @@ public:
   template <typename T>
   void add(std::vector<T> arg);
 
+  /**
+   * As above, but copying the array data directly from a view so that callers
+   * holding data elsewhere (e.g. a pre-generated pool of values) don't need to
+   * materialise a vector first.
+   */
+  template <typename T>
+  void add(llvm::ArrayRef<T> arg);
+
   /**
    * Variadic helper for multiple arguments. The explicit specialisations
    */
@@ -157,6 +175,20 @@ public:
   template <typename T>
   T get(size_t idx) const;
 
+  /**
+   * Non-owning view of the data stored for a pointer argument. Unlike get(),
+   * this doesn't copy the stored elements - the view refers directly to the
+   * builder's internal storage, and so is invalidated by any subsequent
+   * modification of the builder (including calls made with it).
+   *
+   * T must be the element type of the parameter (int64_t, float or char).
+   */
+  template <typename T>
+  llvm::ArrayRef<T> view(size_t idx) const;
+
+  template <typename T>
+  llvm::ArrayRef<T> view(std::string const& name) const;
+
   /**
    * Method for dumping IO examples - retrieves the raw bytes as they'd be
    * passed through to the called function, but segregated by parameter type so
@@ -167,6 +199,8 @@ public:
   /**
    * Testing methods used primarily for dumping IO examples, but can be used for
    * any kind of behaviour that is uniform over the type of contained data.
+   * Pointer arguments are passed to the visitor as views (llvm::ArrayRef) onto
+   * the stored data rather than as copies.
    */
   template <typename ScalarF, typename VectorF>
   void visit_args(ScalarF&& on_scalar, VectorF&& on_vector) const;
@@ -191,10 +225,36 @@ public:
 
   /**
    * Get a pointer to the raw argument data being stored, suitable for being
-   * passed to a call wrapper function.
+   * passed to a call wrapper function. Pointer arguments are written into the
+   * pack at this point, and are invalidated by any subsequent modification of
+   * the builder.
    */
   uint8_t* args();
 
+  /**
+   * The number of bytes needed to hold a packed copy of this builder's
+   * arguments and array data (see pack_into()).
+   */
+  size_t packed_size() const;
+
+  /**
+   * Copy the raw argument data and array data into a single contiguous buffer,
+   * with pointer arguments relocated to refer to the copied arrays. The buffer
+   * must be aligned to 16 bytes and hold at least packed_size() bytes.
+   *
+   * The returned pointer (to the start of the buffer) can be passed directly to
+   * a call wrapper's entry point, including one running in another process
+   * that shares the buffer's mapping.
+   */
+  uint8_t* pack_into(uint8_t* buffer) const;
+
+  /**
+   * Copy array data back from a buffer previously filled by pack_into(), so
+   * that any modifications made by a call using the buffer are visible through
+   * this builder.
+   */
+  void unpack_from(uint8_t const* buffer);
+
   /**
    * Scalar equality comparison - are all the scalar arguments to this builder
    * the same as the ones passed to the other builder? This essentially denotes
@@ -210,19 +270,50 @@ public:
   bool operator==(call_builder const& other) const;
   bool operator!=(call_builder const& other) const;
 
-  /**
-   * ADL swap for copy-and-swap.
-   */
   friend void swap(call_builder& left, call_builder& right);
 
 private:
+  /**
+   * Location of a single pointer argument's data: where its pointer needs to
+   * be written in the argument pack, and where its elements live in the arena.
+   */
+  struct array_slot {
+    size_t arg_offset;
+    size_t data_offset;
+    size_t size;
+  };
+
+  /**
+   * Arrays in the arena are aligned to this boundary so that the called code
+   * can use aligned vector loads and stores on them.
+   */
+  static constexpr size_t arena_alignment = 16;
+
+  /**
+   * View the elements of the nth pointer argument in the arena.
+   */
+  template <typename T>
+  llvm::ArrayRef<T> array_view(size_t ptr_idx) const;
+
+  /**
+   * Offset of the arena data in a packed buffer.
+   */
+  size_t packed_arena_offset() const;
+
+  /**
+   * Find the byte offset of a parameter in the argument pack, and the number
+   * of pointer parameters that precede it.
+   */
+  std::pair<size_t, size_t> locate(size_t idx) const;
+
+  size_t index_of(std::string const& name) const;
+
   props::signature signature_;
   std::vector<uint8_t> args_;
 
   size_t current_arg_ = 0;
-  std::vector<std::vector<int64_t>> int_data_ = {};
-  std::vector<std::vector<float>> float_data_ = {};
-  std::vector<std::vector<char>> char_data_ = {};
+  std::vector<uint8_t> arena_ = {};
+  std::vector<array_slot> arrays_ = {};
 };
 
 struct output_example {
@@ -287,6 +378,12 @@ void call_builder::add(T arg)
 
 template <typename T>
 void call_builder::add(std::vector<T> arg)
+{
+  add(llvm::ArrayRef<T>(arg));
+}
+
+template <typename T>
+void call_builder::add(llvm::ArrayRef<T> arg)
 {
   static_assert(
       is_buildable_int_v<
@@ -319,24 +416,19 @@ void call_builder::add(std::vector<T> arg)
       param.pointer_depth == 1, "Cannot add nested pointers (param: {})",
       param);
 
-  void* data = nullptr;
-  if constexpr (std::is_same_v<T, char>) {
-    char_data_.push_back(arg);
-    data = char_data_.back().data();
-  } else if constexpr (is_buildable_int_v<T>) {
-    int_data_.push_back(arg);
-    data = int_data_.back().data();
-  } else if constexpr (std::is_same_v<T, float>) {
-    float_data_.push_back(arg);
-    data = float_data_.back().data();
+  auto data_offset = (arena_.size() + arena_alignment - 1)
+                     / arena_alignment * arena_alignment;
+  auto bytes = arg.size() * sizeof(T);
+
+  arena_.resize(data_offset + bytes);
+  if (bytes > 0) {
+    memcpy(arena_.data() + data_offset, arg.data(), bytes);
   }
 
-  assertion(
-      data || arg.empty(), "Something very wrong inside vector building!");
+  arrays_.push_back({args_.size(), data_offset, arg.size()});
 
-  for (auto i = 0u; i < sizeof(data); ++i) {
-    args_.push_back(detail::nth_byte(data, i));
-  }
+  // The pointer itself is written by args() once the arena is stable.
+  args_.resize(args_.size() + sizeof(void*), 0);
 
   current_arg_++;
 }
@@ -354,92 +446,113 @@ T call_builder::get(size_t idx) const
     throw call_builder_error("Can't extract - not enough arguments packed");
   }
 
-  size_t offset = 0;
-  size_t int_offset = 0;
-  size_t float_offset = 0;
-  size_t char_offset = 0;
-
-  for (auto i = 0u; i < idx; ++i) {
-    auto const& param = signature_.parameters.at(i);
-
-    if (param.pointer_depth == 0) {
-      offset += base_type_size(param.type);
-    } else {
-      if (param.pointer_depth != 1) {
-        throw std::runtime_error("Can't extract nested pointers");
-      }
-
-      if (param.type == props::base_type::character) {
-        ++char_offset;
-      } else if (param.type == props::base_type::integer) {
-        ++int_offset;
-      } else if (param.type == props::base_type::floating) {
-        ++float_offset;
-      }
-
-      offset += 8;
-    }
-  }
+  auto [offset, ptr_idx] = locate(idx);
 
   if constexpr (
       is_buildable_int_v<
           T> || std::is_same_v<T, float> || std::is_same_v<T, char>) {
     return detail::from_bytes<T>(args_.data() + offset);
   } else if constexpr (std::is_same_v<T, std::vector<int64_t>>) {
-    return int_data_.at(int_offset);
+    return array_view<int64_t>(ptr_idx).vec();
   } else if constexpr (std::is_same_v<T, std::vector<float>>) {
-    return float_data_.at(float_offset);
+    return array_view<float>(ptr_idx).vec();
   } else if constexpr (std::is_same_v<T, std::vector<char>>) {
-    return char_data_.at(float_offset);
+    return array_view<char>(ptr_idx).vec();
   } else {
     static_assert(false_v<T>, "Unknown type when extracting!");
   }
 }
 
 template <typename T>
-T call_builder::get(std::string const& name) const
+llvm::ArrayRef<T> call_builder::array_view(size_t ptr_idx) const
 {
-  auto b = signature_.parameters.begin();
-  auto e = signature_.parameters.end();
+  auto const& slot = arrays_.at(ptr_idx);
+  auto data = reinterpret_cast<T const*>(arena_.data() + slot.data_offset);
+  return llvm::ArrayRef<T>(data, slot.size);
+}
 
-  auto found = std::find_if(b, e, [&](auto p) { return p.name == name; });
-  if (found != e) {
-    return get<T>(std::distance(b, found));
-  } else {
-    throw call_builder_error("Parameter name not found when extracting");
+template <typename T>
+llvm::ArrayRef<T> call_builder::view(size_t idx) const
+{
+  static_assert(
+      is_buildable_int_v<
+          T> || std::is_same_v<T, float> || std::is_same_v<T, char>,
+      "Viewed data must be of base type");
+
+  if (!(idx < current_arg_)) {
+    throw call_builder_error("Can't view - not enough arguments packed");
+  }
+
+  auto const& param = signature_.parameters.at(idx);
+  if (param.pointer_depth != 1) {
+    throw call_builder_error("Can only view data for single pointer arguments");
+  }
+
+  using props::base_type;
+
+  auto type_ok
+      = (is_buildable_int_v<T> && param.type == base_type::integer)
+        || (std::is_same_v<T, float> && param.type == base_type::floating)
+        || (std::is_same_v<T, char> && param.type == base_type::character);
+
+  if (!type_ok) {
+    throw call_builder_error("Viewed type doesn't match parameter type");
   }
+
+  return array_view<T>(locate(idx).second);
+}
+
+template <typename T>
+llvm::ArrayRef<T> call_builder::view(std::string const& name) const
+{
+  return view<T>(index_of(name));
+}
+
+template <typename T>
+T call_builder::get(std::string const& name) const
+{
+  return get<T>(index_of(name));
 }
 
 template <typename ScalarF, typename VectorF>
 void call_builder::visit_args(ScalarF&& on_scalar, VectorF&& on_vector) const
 {
+  size_t offset = 0;
+  size_t ptr_idx = 0;
+
   for (auto i = 0u; i < args_count(); ++i) {
     auto const& param = signature_.parameters.at(i);
+    auto data = args_.data() + offset;
 
     if (param.pointer_depth == 0) {
       if (param.type == props::base_type::character) {
-        std::forward<ScalarF>(on_scalar)(get<char>(i));
+        std::forward<ScalarF>(on_scalar)(detail::from_bytes<char>(data));
       } else if (param.type == props::base_type::integer) {
-        std::forward<ScalarF>(on_scalar)(get<int64_t>(i));
+        std::forward<ScalarF>(on_scalar)(detail::from_bytes<int64_t>(data));
       } else if (param.type == props::base_type::floating) {
-        std::forward<ScalarF>(on_scalar)(get<float>(i));
+        std::forward<ScalarF>(on_scalar)(detail::from_bytes<float>(data));
       } else {
         invalid_state();
       }
+
+      offset += base_type_size(param.type);
     } else {
       assertion(
           param.pointer_depth == 1, "Can't visit nested pointers (param: {})",
           param);
 
       if (param.type == props::base_type::character) {
-        std::forward<VectorF>(on_vector)(get<std::vector<char>>(i));
+        std::forward<VectorF>(on_vector)(array_view<char>(ptr_idx));
       } else if (param.type == props::base_type::integer) {
-        std::forward<VectorF>(on_vector)(get<std::vector<int64_t>>(i));
+        std::forward<VectorF>(on_vector)(array_view<int64_t>(ptr_idx));
       } else if (param.type == props::base_type::floating) {
-        std::forward<VectorF>(on_vector)(get<std::vector<float>>(i));
+        std::forward<VectorF>(on_vector)(array_view<float>(ptr_idx));
       } else {
         invalid_state();
       }
+
+      offset += 8;
+      ++ptr_idx;
     }
   }
 }
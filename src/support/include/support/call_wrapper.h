@@ -4,17 +4,23 @@
 
 #include <props/props.h>
 #include <support/dynamic_library.h>
+#include <support/jit_session.h>
 #include <support/thread_context.h>
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/ExecutionEngine/GenericValue.h>
-#include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ExecutionEngine/Orc/Core.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
 
+#include <atomic>
 #include <chrono>
+#include <map>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace support {
 
@@ -29,19 +35,44 @@ namespace support {
  *
  * A rough overview of how this class works is as follows:
  *
- * On construction, it creates a JIT execution engine. If constructed with a
- * dynamic library, the library is registered with the engine. A reference to
- * the "implementation" (shared library or LLVM function) is stored, and a
+ * On construction, it takes a copy of the module containing the implementation
+ * and prepares it for compilation. If constructed with a dynamic library, the
+ * library symbol is recorded as a mapping for the implementation. A reference
+ * to the "implementation" (shared library or LLVM function) is stored, and a
  * wrapper function is created.
  *
+ * Compilation is deferred until the first call is made: at that point, the
+ * module is added to the calling thread's shared JIT session (see
+ * jit_session). Code is removed from the session again when the wrapper is
+ * destroyed, so creating many short-lived wrappers (e.g. one per synthesis
+ * candidate) does not pay for a new execution engine each time.
+ *
  * This wrapper function always has the same type signature (returns i64,
  * accepts pointer to i8) so that the builder can assemble arguments
  * byte-by-byte, and the wrapper code can interpret the same. It is responsible
- * for marshalling the bytewise data into values of the correct type and calling
- * the implementation with them.
+ * for loading each argument from the packed data as a value of the correct type
+ * and calling the implementation with them.
+ *
+ * A second batch wrapper is also generated, which loops over an array of
+ * argument packs and calls the wrapper on each of them in turn. This lets a
+ * whole set of calls be made with a single transition into JIT-compiled code.
  */
 class call_wrapper {
 public:
+  /**
+   * The type of the native entry point produced by compiling the wrapper
+   * function: it accepts the raw bytes from a call_builder and returns the
+   * implementation's return value extended to 64 bits.
+   */
+  using raw_function = uint64_t (*)(uint8_t*);
+
+  /**
+   * The type of the native batch entry point: it accepts an array of n
+   * pointers to raw argument data, and writes the n return values to the
+   * results array.
+   */
+  using raw_batch_function = void (*)(uint8_t**, uint64_t*, uint64_t);
+
   /**
    * Construct a wrapper for a function by passing the function directly - the
    * parent module and name can be obtained unambiguously from the function.
@@ -81,6 +112,18 @@ public:
       props::signature sig, llvm::Module const& mod, llvm::StringRef name,
       FPtr ptr);
 
+  /**
+   * Wrappers own their compiled code in the JIT session, so they can be moved
+   * but not copied.
+   */
+  call_wrapper(call_wrapper const&) = delete;
+  call_wrapper& operator=(call_wrapper const&) = delete;
+
+  call_wrapper(call_wrapper&&);
+  call_wrapper& operator=(call_wrapper&&) = delete;
+
+  ~call_wrapper();
+
   /**
    * Construct a call builder with the correct type signature for this wrapper.
    */
@@ -99,6 +142,64 @@ public:
   std::pair<uint64_t, std::chrono::nanoseconds>
   call_timed(call_builder& builder);
 
+  /**
+   * Call the wrapped function once for each of the assembled argument packs,
+   * using a single native call to the batch entry point. The return values are
+   * returned in the same order as the packs.
+   */
+  std::vector<uint64_t>
+  call_batch(llvm::MutableArrayRef<call_builder> builders);
+
+  /**
+   * Instrument the implementation so that it can be interrupted when an
+   * external flag is set, returning early with a zero value.
+   *
+   * The flag is checked on entry to the function and at the head of every loop
+   * (i.e. once per back-edge taken), so straight-line code runs without any
+   * extra overhead while every path that could run forever still polls it.
+   * This must be done before the first call is made, and only works for
+   * implementations defined in LLVM IR.
+   *
+   * With no argument, the wrapper uses a flag of its own, which is required to
+   * use call_with_timeout().
+   */
+  void enable_interrupts(std::atomic<bool>* flag);
+  void enable_interrupts();
+
+  /**
+   * Call the wrapped function, interrupting it if it runs for longer than the
+   * time limit. Returns the return value if the call finished in time, or an
+   * empty optional if it was (or may have been) interrupted.
+   *
+   * The timer is run by the shared watchdog thread, so this is cheap enough to
+   * use for every call.
+   */
+  std::optional<uint64_t>
+  call_with_timeout(call_builder& builder, std::chrono::nanoseconds limit);
+
+  /**
+   * Get the native entry point for this wrapper, compiling it if this has not
+   * yet been done. Symbol resolution only happens once - subsequent calls just
+   * return the cached pointer.
+   *
+   * This is the fast path for code that makes very large numbers of calls to
+   * the same wrapper: the returned function can be called directly with the
+   * result of call_builder::args().
+   */
+  raw_function raw_entry();
+
+  /**
+   * Call the native entry point directly with a pointer to marshalled argument
+   * data, bypassing any checks that the argument pack is complete.
+   */
+  uint64_t call_raw(uint8_t* args);
+
+  /**
+   * Get the native batch entry point for this wrapper, compiling it if this has
+   * not yet been done. As with raw_entry(), the result is cached.
+   */
+  raw_batch_function raw_batch_entry();
+
   /**
    * Get the name of the underlying function implementation (if it's not already
    * known, for example if the wrapper was constructed by inferring a candidate
@@ -107,24 +208,49 @@ public:
   std::string name() const;
 
 protected:
-  llvm::Function* implementation() const { return impl_; }
-  std::unique_ptr<llvm::ExecutionEngine> const& engine() const
-  {
-    return engine_;
-  }
+  /**
+   * True once the wrapper's module has been handed to the JIT, which happens
+   * on the first call. After this point the module can no longer be modified.
+   */
+  bool compiled() const;
+
+  /**
+   * The implementation function inside this wrapper's module. Subclasses can
+   * modify the module through this (e.g. to add instrumentation), but only
+   * before the first call is made - after that, the module is owned by the JIT
+   * and this pointer is no longer valid.
+   */
+  llvm::Function* implementation() const;
+
+  /**
+   * Resolve the given declaration in this wrapper's module to an address in
+   * the host process when the module is compiled.
+   */
+  void add_global_mapping(llvm::GlobalValue const* gv, void* addr);
 
 private:
   /**
-   * Runtime sizeof() for LLVM types - gets the size of a type when it is
-   * converted to raw bytes.
+   * Add the module to the JIT session if this hasn't been done already, and
+   * record the names of the symbols that should be looked up to call the
+   * wrapper functions.
    */
-  size_t marshalled_size(llvm::Type const* type) const;
+  void finalize();
 
   /**
-   * Creates a vector of i8 with the given size.
+   * Slow path for raw_entry() - look up the wrapper symbol and cache it.
    */
-  template <typename Builder>
-  llvm::Value* make_vector(Builder& B, size_t size) const;
+  raw_function resolve_entry();
+
+  /**
+   * Slow path for raw_batch_entry().
+   */
+  raw_batch_function resolve_batch_entry();
+
+  /**
+   * Runtime sizeof() for LLVM types - gets the size of a type when it is
+   * converted to raw bytes.
+   */
+  size_t marshalled_size(llvm::Type const* type) const;
 
   /**
    * Create a return instruction from the wrapper function, optionally returning
@@ -139,10 +265,32 @@ private:
   llvm::Function*
   build_wrapper_function(llvm::Module& mod, llvm::Function* fn) const;
 
+  /**
+   * Build a function that calls the wrapper function once for every argument
+   * pack in an array, storing the return values.
+   */
+  llvm::Function*
+  build_batch_function(llvm::Module& mod, llvm::Function* wrapper) const;
+
   props::signature signature_;
+  std::string name_;
+
+  std::unique_ptr<llvm::Module> module_;
   llvm::Function* impl_;
   llvm::Function* wrapper_;
-  std::unique_ptr<llvm::ExecutionEngine> engine_;
+  llvm::Function* batch_wrapper_;
+
+  std::map<llvm::GlobalValue const*, void*> mappings_;
+
+  jit_session* session_;
+  llvm::orc::ResourceTrackerSP tracker_;
+  std::string wrapper_symbol_;
+  std::string batch_symbol_;
+  raw_function entry_;
+  raw_batch_function batch_entry_;
+
+  std::unique_ptr<std::atomic<bool>> own_interrupt_;
+  std::atomic<bool>* interrupt_;
 };
 
 template <typename FPtr>
@@ -151,14 +299,30 @@ call_wrapper::call_wrapper(
     FPtr ptr)
     : call_wrapper(sig, mod, name)
 {
-  engine_->addGlobalMapping(impl_, (void*)ptr);
+  add_global_mapping(impl_, (void*)ptr);
 }
 
-template <typename Builder>
-llvm::Value* call_wrapper::make_vector(Builder& B, size_t size) const
+inline call_wrapper::raw_function call_wrapper::raw_entry()
 {
-  auto vec_ty = llvm::VectorType::get(B.getInt8Ty(), size, false);
-  return llvm::Constant::getNullValue(vec_ty);
+  if (entry_) {
+    return entry_;
+  }
+
+  return resolve_entry();
+}
+
+inline uint64_t call_wrapper::call_raw(uint8_t* args)
+{
+  return raw_entry()(args);
+}
+
+inline call_wrapper::raw_batch_function call_wrapper::raw_batch_entry()
+{
+  if (batch_entry_) {
+    return batch_entry_;
+  }
+
+  return resolve_batch_entry();
 }
 
 template <typename Builder>
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <support/call_builder.h>
+
+#include <props/props.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace support {
+
+/**
+ * Custom exception class for errors reading or writing recorded example files.
+ */
+class example_file_error : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * Recorded input / output examples are stored in a compact binary format that
+ * can be read back by mapping the file into memory, rather than parsing text.
+ *
+ * A file starts with a header:
+ *
+ *   magic     8 bytes, "IOEXMPL\0"
+ *   version   uint32_t
+ *   sig_len   uint32_t
+ *   count     uint64_t (or unknown_count if the writer couldn't seek back)
+ *   sig       sig_len bytes, the signature as formatted by props
+ *
+ * followed by one record per example. Each record holds every argument before
+ * the call, then every pointer argument after the call, then the raw return
+ * value as a uint64_t. Scalars take a single 8-byte slot, and arrays are stored
+ * as a uint64_t element count followed by their elements. Every field (and the
+ * signature) is padded to 8 bytes, so that the arrays in a mapped file are
+ * suitably aligned to be viewed in place.
+ *
+ * All values are in host byte order; the files are a cache for local use
+ * rather than an interchange format.
+ */
+namespace example_file {
+
+constexpr char magic[8] = {'I', 'O', 'E', 'X', 'M', 'P', 'L', '\0'};
+constexpr uint32_t version = 1;
+constexpr uint64_t unknown_count = ~uint64_t {0};
+
+} // namespace example_file
+
+/**
+ * Streams examples to a file in the format above. Examples are written as they
+ * are recorded, so memory use doesn't depend on how many there are.
+ *
+ * Passing "-" as the path writes to standard output; the example count can't be
+ * patched into the header afterwards in that case, so readers have to scan the
+ * file to find it.
+ */
+class example_writer {
+public:
+  example_writer(std::string const& path, props::signature sig);
+  ~example_writer();
+
+  example_writer(example_writer const&) = delete;
+  example_writer& operator=(example_writer const&) = delete;
+
+  /**
+   * Record one example: the arguments before the call, the arguments after the
+   * call (only the pointer arguments of which are stored), and the value
+   * returned by the call.
+   */
+  void write(
+      call_builder const& input, call_builder const& output,
+      uint64_t return_value);
+
+  /**
+   * Flush everything and fill in the example count. Called by the destructor
+   * if it hasn't been already, but errors can only be reported by calling it
+   * explicitly.
+   */
+  void close();
+
+  size_t written() const;
+
+private:
+  template <typename T>
+  void put(T val);
+
+  void put_bytes(void const* data, size_t n);
+
+  props::signature signature_;
+  std::FILE* file_;
+  bool owns_file_;
+
+  size_t written_;
+
+  // Each record is assembled here and written in one go.
+  std::vector<uint8_t> buffer_;
+};
+
+/**
+ * Read-only view of a recorded example file. The file is mapped into memory
+ * when the reader is constructed, and indexed with a single pass over the
+ * record headers; examples are only decoded when requested.
+ */
+class example_reader {
+public:
+  explicit example_reader(std::string const& path);
+  ~example_reader();
+
+  example_reader(example_reader const&) = delete;
+  example_reader& operator=(example_reader const&) = delete;
+
+  props::signature const& signature() const;
+
+  size_t size() const;
+
+  /**
+   * Decode the arguments of the nth example, before and after its call.
+   */
+  call_builder input(size_t n) const;
+  output_example output(size_t n) const;
+
+private:
+  /**
+   * Decode the record starting at offset into a builder, taking pointer data
+   * from the post-call section if after is true. Returns the offset just past
+   * the end of the record, and stores its return value.
+   */
+  size_t decode(
+      size_t offset, bool after, call_builder* build,
+      uint64_t* return_value) const;
+
+  uint64_t read_word(size_t offset) const;
+
+  std::string path_;
+
+  uint8_t const* data_;
+  size_t size_;
+
+  props::signature signature_;
+  std::vector<size_t> offsets_;
+};
+
+} // namespace support
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <support/argument_generator.h>
+#include <support/call_builder.h>
+#include <support/call_wrapper.h>
+#include <support/example_file.h>
+#include <support/sandbox.h>
+
+#include <props/props.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace support {
+
+/**
+ * A set of input / output examples computed once from a reference
+ * implementation, that can then be replayed against many candidate
+ * implementations.
+ *
+ * When testing lots of candidates, most of them will be wrong in the same way,
+ * and the same few examples will be enough to reject them. To take advantage of
+ * this, the set keeps track of an ordering over its examples: whenever an
+ * example rejects a candidate, it is moved to the front of the order so that it
+ * will be tried first next time. Most wrong candidates then fail on the first
+ * or second call, without needing to run the rest of the set.
+ */
+class example_set {
+public:
+  struct example {
+    call_builder input;
+    output_example output;
+  };
+
+  explicit example_set(props::signature sig);
+
+  /**
+   * Generate n new examples using the generator, and compute the expected
+   * outputs for them by calling the reference implementation.
+   */
+  void generate(call_wrapper& ref, argument_generator gen, size_t n);
+
+  /**
+   * Add a single example from a complete argument pack, computing its expected
+   * output by calling the reference implementation.
+   */
+  void add(call_wrapper& ref, call_builder input);
+
+  /**
+   * Add every example recorded in a file (see example_writer), using the
+   * recorded outputs rather than calling a reference implementation.
+   */
+  void load(example_reader const& file);
+
+  /**
+   * Returns true if the candidate produces the expected output for every
+   * example in the set, stopping at the first example that fails. The failing
+   * example is moved to the front of the replay order.
+   */
+  bool check(call_wrapper& cand);
+
+  /**
+   * As above, but running the candidate in a sandboxed worker process. Crashes
+   * and timeouts are treated as failing the example that caused them.
+   */
+  bool check(sandbox& cand);
+
+  /**
+   * Measure how far a candidate is from the reference over the whole set, as
+   * the sum of err(expected, actual) for each example. Unlike check(), this
+   * always runs every example, so that partly-correct candidates can be
+   * ranked against each other.
+   */
+  using error_function
+      = std::function<int(output_example const&, output_example const&)>;
+
+  int64_t error(call_wrapper& cand, error_function const& err);
+
+  /**
+   * As above, but in a sandboxed worker process. Returns an empty optional if
+   * the candidate crashes or times out on any example.
+   */
+  std::optional<int64_t> error(sandbox& cand, error_function const& err);
+
+  /**
+   * Access the stored examples in their original insertion order.
+   */
+  std::vector<example> const& examples() const;
+
+  size_t size() const;
+  bool empty() const;
+
+  props::signature const& signature() const;
+
+private:
+  template <typename CallF>
+  bool check_with(CallF&& call);
+
+  template <typename CallF>
+  bool check_one(CallF&& call, example& ex);
+
+  template <typename CallF>
+  std::optional<int64_t> error_with(CallF&& call, error_function const& err);
+
+  props::signature signature_;
+  std::vector<example> examples_;
+
+  // Indexes into examples_, in the order they should be replayed.
+  std::vector<size_t> order_;
+
+  // Candidates are called on a copy of each input; reusing the same pack for
+  // every call means its storage is only allocated once.
+  call_builder scratch_;
+
+  // The same applies to the outputs collected when measuring error.
+  output_example actual_;
+};
+
+} // namespace support
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <llvm/IR/Function.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+
+namespace support {
+
+/**
+ * Compute a structural fingerprint of a function's body, such that functions
+ * that differ only in naming get the same fingerprint.
+ *
+ * Values are identified by position (arguments by index, instructions by their
+ * order in the function) rather than by name, and the function's own name is
+ * ignored. Unreachable blocks and trivially dead instructions are skipped,
+ * which is a cheap normalisation of the same kind that a cleanup pass would
+ * do. Types, constants and callees are hashed by their structure and names
+ * rather than by address, so fingerprints can be compared across LLVM contexts
+ * (and so across threads).
+ *
+ * Equal fingerprints mean that the functions are (up to a 64-bit hash
+ * collision) identical after this normalisation; functions that compute the
+ * same thing in different ways can still have different fingerprints.
+ */
+uint64_t fingerprint(llvm::Function const&);
+
+/**
+ * A thread-safe set of fingerprints, used to skip candidates that have
+ * already been tested. Workers searching in parallel can share one cache so
+ * that none of them repeats a candidate that another has tried.
+ */
+class fingerprint_cache {
+public:
+  fingerprint_cache() = default;
+
+  fingerprint_cache(fingerprint_cache const&) = delete;
+  fingerprint_cache& operator=(fingerprint_cache const&) = delete;
+
+  /**
+   * Record a fingerprint, returning true if it hasn't been seen before.
+   */
+  bool insert(uint64_t);
+
+  /**
+   * Convenience for inserting a function's fingerprint.
+   */
+  bool insert(llvm::Function const&);
+
+  /**
+   * The number of distinct fingerprints seen, and the number of insertions
+   * rejected as duplicates.
+   */
+  size_t size() const;
+  size_t hits() const;
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_set<uint64_t> seen_ = {};
+  size_t hits_ = 0;
+};
+
+} // namespace support
@@ -2,7 +2,10 @@
 
 #include <support/type_finder.h>
 
+#include <llvm/ADT/ArrayRef.h>
+
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 #include <vector>
@@ -53,27 +56,73 @@ bool ulp_equal(Float A, Float B, int max_ulp_diff)
 
 int ulp_diff(float A, float B);
 
+/**
+ * Two floats are considered equal if they are within max_ulps representable
+ * values of each other, or if their absolute difference is at most max_abs.
+ */
+struct float_tolerance {
+  int max_ulps = 10;
+  float max_abs = 0.001f;
+};
+
+/**
+ * Result of comparing two arrays. Comparison stops at the first mismatching
+ * element, so max_error is the largest absolute difference between elements
+ * up to and including that point (NaN differences are ignored). If the arrays
+ * have different sizes, mismatch_index is the size of the shorter one.
+ */
+struct comparison_result {
+  bool equal;
+  size_t mismatch_index;
+  double max_error;
+};
+
+/**
+ * Instruction set extensions that the array comparison kernels can use. The
+ * best available level is detected once at runtime; comparisons can also be
+ * run at a specific level (for testing the kernels against each other).
+ */
+enum class simd_level { scalar, sse2, avx2 };
+
+simd_level best_simd_level();
+
+comparison_result compare_arrays(
+    llvm::ArrayRef<float> a, llvm::ArrayRef<float> b,
+    float_tolerance tol = {});
+
+comparison_result compare_arrays(
+    llvm::ArrayRef<float> a, llvm::ArrayRef<float> b, float_tolerance tol,
+    simd_level level);
+
+comparison_result
+compare_arrays(llvm::ArrayRef<int64_t> a, llvm::ArrayRef<int64_t> b);
+
+comparison_result compare_arrays(llvm::ArrayRef<char> a, llvm::ArrayRef<char> b);
+
 template <typename T>
 bool approx_equal(T&& a, T&& b)
 {
   using ElemT = typename std::decay_t<T>::value_type;
 
-  if constexpr (std::is_floating_point_v<ElemT>) {
+  if constexpr (std::is_same_v<ElemT, float>) {
+    return compare_arrays(llvm::ArrayRef<float>(a), llvm::ArrayRef<float>(b))
+        .equal;
+  } else if constexpr (std::is_floating_point_v<ElemT>) {
     if (a.size() != b.size()) {
       return false;
     }
 
     for (auto i = 0u; i < a.size(); ++i) {
-      auto approx = ulp_equal(a.at(i), b.at(i), 10)
-          || std::abs(a.at(i) - b.at(i)) <= 0.001;
+      auto approx
+          = ulp_equal(a[i], b[i], 10) || std::abs(a[i] - b[i]) <= 0.001;
       if (!approx) {
         return false;
       }
     }
 
     return true;
+  } else {
+    return a == b;
   }
-
-  return a == b;
 }
 } // namespace support
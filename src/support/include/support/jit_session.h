@@ -0,0 +1,82 @@
+#pragma once
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Module.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace support {
+
+/**
+ * Long-lived JIT compilation session shared by every call wrapper created on
+ * the same thread.
+ *
+ * Creating a fresh execution engine for every function we want to call means
+ * that target machine construction, symbol resolution setup and so on dominate
+ * the cost of evaluating small candidate programs. Instead, each thread owns a
+ * single ORC JIT; wrappers add their modules to it incrementally, and remove
+ * them again when they are destroyed.
+ *
+ * Because every wrapper's module lives in the same symbol namespace, modules
+ * are given a unique identifier on entry to the session. Callers are
+ * responsible for using this to disambiguate their symbol names.
+ */
+class jit_session {
+public:
+  jit_session(jit_session const&) = delete;
+  jit_session& operator=(jit_session const&) = delete;
+
+  /**
+   * Get the session for the calling thread, creating it if this is the first
+   * time it has been requested.
+   */
+  static jit_session& get();
+
+  /**
+   * The data layout that modules need to have in order to be added to this
+   * session.
+   */
+  llvm::DataLayout const& data_layout() const;
+
+  /**
+   * Get a fresh identifier to use when naming symbols in a module that will be
+   * added to this session.
+   */
+  size_t next_id();
+
+  /**
+   * Add a module to the session, along with a set of absolute symbol mappings
+   * that will be used to resolve the named declarations in the module. The
+   * returned tracker owns the compiled code and mappings, and can be passed to
+   * remove() to free them.
+   *
+   * Compilation is lazy - no code is generated until a symbol from the module
+   * is looked up.
+   */
+  llvm::orc::ResourceTrackerSP add_module(
+      std::unique_ptr<llvm::Module>&& mod,
+      std::map<std::string, void*> const& mappings);
+
+  /**
+   * Remove everything associated with a tracker from the session.
+   */
+  void remove(llvm::orc::ResourceTrackerSP const& tracker);
+
+  /**
+   * Look up the address of a named (unmangled) symbol, compiling the module
+   * that defines it if required.
+   */
+  void* lookup(std::string const& name);
+
+private:
+  jit_session();
+
+  std::unique_ptr<llvm::orc::LLJIT> jit_;
+  size_t next_id_;
+};
+
+} // namespace support
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace support {
+
+/**
+ * Collects chunks of output produced out of order (for example by the jobs in
+ * a work_queue), and writes them to a file in index order.
+ *
+ * Each chunk is written as soon as every chunk before it has been, so output
+ * from a long parallel run still appears incrementally, and the final output is
+ * identical to what a serial run would have produced.
+ */
+class ordered_writer {
+public:
+  explicit ordered_writer(std::FILE* out);
+
+  ordered_writer(ordered_writer const&) = delete;
+  ordered_writer& operator=(ordered_writer const&) = delete;
+
+  /**
+   * Supply the output for chunk index. Can be called concurrently from any
+   * thread, but each index should only be written once.
+   */
+  void write(size_t index, std::string text);
+
+  /**
+   * The number of chunks that have been written to the underlying file.
+   */
+  size_t written() const;
+
+private:
+  std::FILE* out_;
+  size_t next_;
+
+  std::map<size_t, std::string> pending_;
+  mutable std::mutex mutex_;
+};
+
+} // namespace support
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <support/call_builder.h>
+#include <support/call_wrapper.h>
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace support {
+
+/**
+ * Custom exception class for errors setting up or communicating with a
+ * sandboxed worker process (as opposed to errors in the code being run, which
+ * are reported through sandbox_result).
+ */
+class sandbox_error : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+enum class sandbox_status { ok, crashed, timed_out };
+
+struct sandbox_result {
+  sandbox_status status;
+  uint64_t return_value;
+
+  // If the worker crashed, the signal that killed it (or 0 if it exited).
+  int signal;
+
+  bool ok() const { return status == sandbox_status::ok; }
+};
+
+/**
+ * Runs a call wrapper's compiled code in a separate worker process, so that
+ * crashes or infinite loops in the code only kill the worker rather than the
+ * whole program.
+ *
+ * The wrapper is compiled in this process, and then a worker is forked that
+ * shares a region of memory with it. Each call copies the argument pack into
+ * the shared region (see call_builder::pack_into), signals the worker, and
+ * waits for the return value; any array arguments modified by the call are
+ * copied back out afterwards. Because the worker is forked after compilation,
+ * the entry point and shared buffer are at the same addresses in both
+ * processes.
+ *
+ * If the worker crashes or doesn't respond within the timeout, it is killed and
+ * the call reports the failure. A new worker is forked lazily on the next call.
+ *
+ * Workers only ever execute JIT-compiled code and make raw system calls, so
+ * they are safe to fork from multi-threaded programs.
+ */
+class sandbox {
+public:
+  static constexpr size_t default_shared_size = size_t(64) << 20;
+
+  /**
+   * Create a sandbox for the given wrapper, which must outlive the sandbox.
+   * Argument packs passed to call() can be at most shared_size bytes once
+   * packed.
+   */
+  explicit sandbox(
+      call_wrapper& wrap,
+      std::chrono::milliseconds timeout = std::chrono::seconds(1),
+      size_t shared_size = default_shared_size);
+
+  sandbox(sandbox const&) = delete;
+  sandbox& operator=(sandbox const&) = delete;
+
+  ~sandbox();
+
+  /**
+   * Call the wrapped function in the worker process. If the call succeeds, the
+   * builder's array arguments are updated to reflect any changes made by the
+   * call.
+   */
+  sandbox_result call(call_builder& build);
+
+  /**
+   * The number of times a worker process has had to be restarted after a crash
+   * or timeout.
+   */
+  size_t restarts() const;
+
+private:
+  void start();
+  int stop();
+
+  call_wrapper::raw_function entry_;
+  std::chrono::milliseconds timeout_;
+
+  uint8_t* shared_;
+  size_t shared_size_;
+
+  pid_t worker_;
+  int socket_;
+
+  size_t restarts_;
+};
+
+} // namespace support
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/LLVMContext.h>
 
 #include <memory>
@@ -18,6 +19,14 @@ public:
   static llvm::LLVMContext& get(std::thread::id id);
   static llvm::LLVMContext& get(const std::thread& t);
 
+  /**
+   * Get the thread-safe handle that owns the context for this thread. This is
+   * what the JIT needs in order to take ownership of modules created in the
+   * per-thread context.
+   */
+  static llvm::orc::ThreadSafeContext safe();
+  static llvm::orc::ThreadSafeContext safe(std::thread::id id);
+
 private:
   thread_context()
       : mapping_{}
@@ -26,8 +35,7 @@ private:
 
   static thread_context& instance();
 
-  std::unordered_map<std::thread::id, std::unique_ptr<llvm::LLVMContext>>
-      mapping_;
+  std::unordered_map<std::thread::id, llvm::orc::ThreadSafeContext> mapping_;
 
   std::mutex map_mutex_;
 };
@@ -1,29 +1,33 @@
 #pragma once
 
+#include <support/watchdog.h>
+
 #include <chrono>
-#include <thread>
 
 namespace support {
 
 // Note when calling a timed-out operation, the timeout function needs to cause
 // some kind of action that kills or interrupts the main thread's work (e.g.
 // setting a flag somewhere).
+//
+// The timeout function runs on the shared watchdog thread rather than a new
+// thread per call. It is guaranteed not to be running (or to run later) once
+// this function returns, including when the operation throws.
 template <typename Rep, typename Period, typename Operation, typename Timeout>
 void timeout(
     std::chrono::duration<Rep, Period> const& d, Operation&& op, Timeout&& time)
 {
-  auto run_cleanup = true;
-
-  std::thread([&] {
-    std::this_thread::sleep_for(d);
+  auto& dog = watchdog::get();
+  auto h = dog.schedule_after(d, [&time] { std::forward<Timeout>(time)(); });
 
-    if (run_cleanup) {
-      std::forward<Timeout>(time)();
-    }
-  }).detach();
+  try {
+    std::forward<Operation>(op)();
+  } catch (...) {
+    dog.cancel(h);
+    throw;
+  }
 
-  std::forward<Operation>(op)();
-  run_cleanup = false;
+  dog.cancel(h);
 }
 
 } // namespace support
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace support {
+
+/**
+ * A single background thread shared by every part of the program that needs
+ * to run an action after a deadline (typically to interrupt some long-running
+ * work).
+ *
+ * Starting a new thread for every guarded operation is expensive compared to
+ * the operations themselves (e.g. a single call to a synthesised candidate), so
+ * instead actions are queued in deadline order and run by the watchdog thread
+ * when they expire. Most actions are cancelled before their deadline, which
+ * only needs a map lookup.
+ */
+class watchdog {
+public:
+  using clock = std::chrono::steady_clock;
+  using handle = uint64_t;
+
+  watchdog(watchdog const&) = delete;
+  watchdog& operator=(watchdog const&) = delete;
+
+  ~watchdog();
+
+  /**
+   * Get the process-wide watchdog, starting its thread if this is the first
+   * time it has been requested.
+   */
+  static watchdog& get();
+
+  /**
+   * Schedule an action to be run on the watchdog thread at (or shortly after)
+   * the given deadline. Actions should be short - they delay every other
+   * pending action while they run.
+   */
+  handle schedule(clock::time_point deadline, std::function<void()> action);
+
+  template <typename Rep, typename Period>
+  handle schedule_after(
+      std::chrono::duration<Rep, Period> const& d,
+      std::function<void()> action);
+
+  /**
+   * Cancel a scheduled action. Returns true if the action was cancelled before
+   * it started running. If the action is running when this is called, waits
+   * for it to finish before returning false, so that once cancel() returns it
+   * is safe to destroy anything the action refers to.
+   */
+  bool cancel(handle h);
+
+private:
+  watchdog();
+
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable finished_;
+
+  std::map<std::pair<clock::time_point, handle>, std::function<void()>>
+      pending_;
+  std::unordered_map<handle, clock::time_point> deadlines_;
+
+  handle next_;
+  std::optional<handle> running_;
+  bool stop_;
+
+  std::thread thread_;
+};
+
+template <typename Rep, typename Period>
+watchdog::handle watchdog::schedule_after(
+    std::chrono::duration<Rep, Period> const& d, std::function<void()> action)
+{
+  return schedule(
+      clock::now() + std::chrono::duration_cast<clock::duration>(d),
+      std::move(action));
+}
+
+} // namespace support
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace support {
+
+/**
+ * Runs a fixed number of independent jobs, identified by their index, across a
+ * pool of worker threads.
+ *
+ * The tools that process a manifest of functions (or a directory of property
+ * sets) do a lot of independent, CPU-bound work per entry, so running entries
+ * one after another leaves most of the machine idle. Workers take the next
+ * unclaimed index from a shared counter, so long-running entries don't hold up
+ * the rest of a statically assigned shard.
+ *
+ * Each worker thread gets its own LLVM context and JIT session (through
+ * thread_context and jit_session), so anything that has to be created once per
+ * thread, such as a copy of an input module, should be created by the worker
+ * factory passed to run().
+ */
+class work_queue {
+public:
+  /**
+   * Create a queue that runs jobs on up to the given number of threads. Zero
+   * means one thread per hardware thread.
+   */
+  explicit work_queue(unsigned threads = 0);
+
+  unsigned threads() const;
+
+  /**
+   * Run jobs 0 to n-1. make_worker is called once on each worker thread, and
+   * should return a callable that is then invoked with each index the thread
+   * claims.
+   *
+   * Blocks until every job has finished. If a job throws, the remaining
+   * unclaimed jobs are abandoned and the first exception is rethrown here.
+   */
+  template <typename MakeWorker>
+  void run(size_t n, MakeWorker&& make_worker);
+
+private:
+  unsigned threads_;
+};
+
+template <typename MakeWorker>
+void work_queue::run(size_t n, MakeWorker&& make_worker)
+{
+  auto next = std::atomic<size_t> {0};
+
+  auto error = std::exception_ptr {};
+  auto error_mutex = std::mutex {};
+
+  auto work = [&] {
+    try {
+      auto worker = make_worker();
+
+      for (auto i = next++; i < n; i = next++) {
+        worker(i);
+      }
+    } catch (...) {
+      auto lock = std::lock_guard {error_mutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+
+      next = n;
+    }
+  };
+
+  auto pool = std::vector<std::thread> {};
+  auto n_threads = std::min<size_t>(threads_, n);
+
+  for (auto i = 0u; i < n_threads; ++i) {
+    pool.emplace_back(work);
+  }
+
+  for (auto& t : pool) {
+    t.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace support
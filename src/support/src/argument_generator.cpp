@@ -39,13 +39,16 @@ uniform_generator::uniform_generator(size_t sz)
     , int_max(sz - 1)
     , float_min(-5.0)
     , float_max(5.0)
-    , engine_(get_random_device()())
+    , engine_(random_seed())
+    , fast_engine_(random_seed())
     , size_(sz)
     , reuse_(false)
-    , int_arrays_ {}
-    , float_arrays_ {}
-    , char_arrays_ {}
-    , prealloc_idx_(0)
+    , pool_arrays_(0)
+    , pool_bounds_ {}
+    , sizes_ {}
+    , int_data_ {}
+    , float_data_ {}
+    , char_data_ {}
 {
 }
 
@@ -54,23 +57,95 @@ uniform_generator::uniform_generator()
 {
 }
 
+uniform_generator::uniform_generator(property_set const& ps, size_t sz)
+    : uniform_generator(sz)
+{
+  ps.for_each_named("size", [&](auto const& prop) {
+    auto const& ptr = prop.values.at(0).param_val;
+    auto const& size = prop.values.at(1).param_val;
+
+    sizes_[ptr] = {size, 1};
+  });
+
+  ps.for_each_named("pack", [&](auto const& prop) {
+    auto const& ptr = prop.values.at(0).param_val;
+
+    if (auto found = sizes_.find(ptr); found != sizes_.end()) {
+      found->second.pack = prop.values.at(1).int_val;
+    }
+  });
+}
+
 void uniform_generator::seed(std::random_device::result_type seed)
 {
   engine_.seed(seed);
+  fast_engine_.seed(seed);
+
+  if (reuse_) {
+    fill_pools();
+  }
 }
 
 void uniform_generator::preallocate(size_t n)
 {
   reuse_ = true;
+  pool_arrays_ = n;
+
+  fill_pools();
+}
+
+int64_t uniform_generator::gen_size()
+{
+  auto lo = std::max(int_min, 0);
+  auto hi = std::max(int_max, lo);
+
+  return std::uniform_int_distribution<int64_t>(lo, hi)(engine_);
+}
 
-  for (auto i = 0u; i < n; ++i) {
-    int_arrays_.push_back(gen_array_internal<int64_t>());
-    float_arrays_.push_back(gen_array_internal<float>());
-    char_arrays_.push_back(gen_array_internal<char>());
+size_t uniform_generator::array_length(
+    std::string const& ptr,
+    std::map<std::string, int64_t> const& size_values) const
+{
+  auto spec = sizes_.find(ptr);
+  if (spec == sizes_.end()) {
+    return array_size();
+  }
+
+  auto value = size_values.find(spec->second.size_param);
+  if (value == size_values.end()) {
+    return array_size();
   }
+
+  return static_cast<size_t>(
+      std::max(value->second, int64_t {0}) * spec->second.pack);
+}
+
+size_t uniform_generator::array_size() const
+{
+  // Cubing here to ensure that sizes are respected even if we're in the
+  // presence of (say) an O(n^3) algorithm.
+  return size_ * size_ * size_;
+}
+
+uniform_generator::bounds uniform_generator::current_bounds() const
+{
+  return {int_min, int_max, float_min, float_max};
 }
 
-void uniform_generator::reset() { prealloc_idx_ = 0; }
+void uniform_generator::fill_pools()
+{
+  auto len = array_size() * (pool_arrays_ + 1);
+
+  int_data_.resize(len);
+  float_data_.resize(len);
+  char_data_.resize(len);
+
+  fill(int_data_);
+  fill(float_data_);
+  fill(char_data_);
+
+  pool_bounds_ = current_bounds();
+}
 
 template <>
 int64_t uniform_generator::gen_single<int64_t>()
@@ -101,24 +176,13 @@ float uniform_generator::gen_single<float>()
 
 void uniform_generator::gen_args(call_builder& build)
 {
-  reset();
-
-  // clang-format off
-  sig_visitor {
-    on(base_type::integer,      [&] { build.add(gen_single<int64_t>()); }),
-    on(base_type::character,    [&] { build.add(gen_single<char>()); }),
-    on(base_type::floating,     [&] { build.add(gen_single<float>()); }),
-    on(base_type::integer,   1, [&] { build.add(gen_array<int64_t>()); }),
-    on(base_type::character, 1, [&] { build.add(gen_array<char>()); }),
-    on(base_type::floating,  1, [&] { build.add(gen_array<float>()); })
-  }.visit(build.signature());
-  // clang-format on
+  gen_args(build, std::unordered_map<std::string, int64_t> {});
 }
 
 // CSR Generator Implementation
 csr_generator::csr_generator()
     : max_size_(128)
-    , engine_(get_random_device()())
+    , engine_(random_seed())
 {
 }
 
@@ -16,57 +16,14 @@ call_builder::call_builder(props::signature sig)
 
 signature const& call_builder::signature() const { return signature_; }
 
-call_builder::call_builder(call_builder const& other)
-    : signature_(other.signature_)
-    , current_arg_(0)
-    , int_data_(other.int_data_)
-    , float_data_(other.float_data_)
-    , char_data_(other.char_data_)
+void call_builder::reset()
 {
   args_.clear();
-
-  size_t offset = 0;
-  size_t int_offset = 0;
-  size_t float_offset = 0;
-  size_t char_offset = 0;
-
-  for (auto const& param : signature_.parameters) {
-    if (current_arg_ >= other.current_arg_) {
-      break;
-    }
-
-    if (param.pointer_depth == 0) {
-      // TODO: fix size for more types
-      for (auto i = 0u; i < base_type_size(param.type); ++i, ++offset) {
-        args_.push_back(other.args_.at(offset));
-      }
-    } else {
-      assertion(
-          param.pointer_depth == 1, "Can't copy nested pointers (param is {})",
-          param);
-
-      void* data = nullptr;
-      if (param.type == base_type::integer) {
-        data = int_data_.at(int_offset++).data();
-      } else if (param.type == base_type::character) {
-        data = char_data_.at(char_offset++).data();
-      } else if (param.type == base_type::floating) {
-        data = float_data_.at(float_offset++).data();
-      }
-
-      for (auto i = 0u; i < sizeof(void*); ++i) {
-        args_.push_back(detail::nth_byte(data, i));
-      }
-
-      offset += 8;
-    }
-
-    current_arg_++;
-  }
+  arena_.clear();
+  arrays_.clear();
+  current_arg_ = 0;
 }
 
-void call_builder::reset() { *this = call_builder(signature_); }
-
 bool call_builder::ready() const
 {
   return current_arg_ == signature_.parameters.size();
@@ -79,12 +36,6 @@ size_t call_builder::args_capacity() const
   return signature().parameters.size();
 }
 
-call_builder& call_builder::operator=(call_builder other)
-{
-  swap(*this, other);
-  return *this;
-}
-
 void call_builder::add(int arg) { add(static_cast<long>(arg)); }
 
 void swap(call_builder& left, call_builder& right)
@@ -93,9 +44,8 @@ void swap(call_builder& left, call_builder& right)
   swap(left.signature_, right.signature_);
   swap(left.args_, right.args_);
   swap(left.current_arg_, right.current_arg_);
-  swap(left.int_data_, right.int_data_);
-  swap(left.float_data_, right.float_data_);
-  swap(left.char_data_, right.char_data_);
+  swap(left.arena_, right.arena_);
+  swap(left.arrays_, right.arrays_);
 }
 
 uint8_t* call_builder::args()
@@ -103,9 +53,87 @@ uint8_t* call_builder::args()
   assertion(
       ready(), "Argument pack not fully built yet (count: {}, expected: {})",
       args_count(), args_capacity());
+
+  for (auto const& slot : arrays_) {
+    auto ptr = static_cast<void*>(arena_.data() + slot.data_offset);
+    memcpy(args_.data() + slot.arg_offset, &ptr, sizeof(ptr));
+  }
+
   return args_.data();
 }
 
+size_t call_builder::packed_arena_offset() const
+{
+  return (args_.size() + arena_alignment - 1) / arena_alignment
+         * arena_alignment;
+}
+
+size_t call_builder::packed_size() const
+{
+  return packed_arena_offset() + arena_.size();
+}
+
+uint8_t* call_builder::pack_into(uint8_t* buffer) const
+{
+  assertion(
+      ready(), "Argument pack not fully built yet (count: {}, expected: {})",
+      args_count(), args_capacity());
+
+  auto arena = buffer + packed_arena_offset();
+
+  std::copy(args_.begin(), args_.end(), buffer);
+  std::copy(arena_.begin(), arena_.end(), arena);
+
+  for (auto const& slot : arrays_) {
+    auto ptr = static_cast<void*>(arena + slot.data_offset);
+    memcpy(buffer + slot.arg_offset, &ptr, sizeof(ptr));
+  }
+
+  return buffer;
+}
+
+void call_builder::unpack_from(uint8_t const* buffer)
+{
+  auto arena = buffer + packed_arena_offset();
+  std::copy(arena, arena + arena_.size(), arena_.begin());
+}
+
+std::pair<size_t, size_t> call_builder::locate(size_t idx) const
+{
+  size_t offset = 0;
+  size_t ptr_idx = 0;
+
+  for (auto i = 0u; i < idx; ++i) {
+    auto const& param = signature_.parameters.at(i);
+
+    if (param.pointer_depth == 0) {
+      offset += base_type_size(param.type);
+    } else {
+      if (param.pointer_depth != 1) {
+        throw std::runtime_error("Can't extract nested pointers");
+      }
+
+      ++ptr_idx;
+      offset += 8;
+    }
+  }
+
+  return {offset, ptr_idx};
+}
+
+size_t call_builder::index_of(std::string const& name) const
+{
+  auto b = signature_.parameters.begin();
+  auto e = signature_.parameters.end();
+
+  auto found = std::find_if(b, e, [&](auto p) { return p.name == name; });
+  if (found == e) {
+    throw call_builder_error("Parameter name not found when extracting");
+  }
+
+  return std::distance(b, found);
+}
+
 bool call_builder::scalar_args_equal(call_builder const& other) const
 {
   if (args_.size() != other.args_.size()) {
@@ -156,25 +184,20 @@ std::vector<uint8_t> call_builder::get_bytes(size_t idx) const
       throw std::runtime_error("Can't extract nested pointers");
     }
 
-    auto ret = std::vector<uint8_t> {};
-    auto copy_bytes = [&ret](auto&& args) {
-      for (auto i = 0u; i < args.size(); ++i) {
-        auto bytes = detail::to_bytes(args[i]);
-        std::copy(bytes.begin(), bytes.end(), std::back_inserter(ret));
-      }
+    auto copy_bytes = [](auto&& args) {
+      auto begin = reinterpret_cast<uint8_t const*>(args.data());
+      return std::vector<uint8_t>(begin, begin + args.size() * sizeof(args[0]));
     };
 
     if (param.type == props::base_type::character) {
-      copy_bytes(get<std::vector<char>>(idx));
+      return copy_bytes(view<char>(idx));
     } else if (param.type == props::base_type::integer) {
-      copy_bytes(get<std::vector<int64_t>>(idx));
+      return copy_bytes(view<int64_t>(idx));
     } else if (param.type == props::base_type::floating) {
-      copy_bytes(get<std::vector<float>>(idx));
+      return copy_bytes(view<float>(idx));
     } else {
       invalid_state();
     }
-
-    return ret;
   }
 }
 
@@ -194,11 +217,9 @@ bool call_builder::operator==(call_builder const& other) const
   // our iteration. Skips over pointers
   size_t offset = 0;
 
-  // Offsets into the stored data vectors - updated each time we see a
-  // parameter of the appropriate data type.
-  size_t int_data_offset = 0;
-  size_t float_data_offset = 0;
-  size_t char_data_offset = 0;
+  // Index of the current pointer argument - updated each time we see a
+  // pointer parameter.
+  size_t ptr_idx = 0;
 
   bool all_eq = true;
 
@@ -220,21 +241,20 @@ bool call_builder::operator==(call_builder const& other) const
 
       if (param.type == base_type::integer) {
         all_eq = all_eq
-                 && (int_data_.at(int_data_offset)
-                     == other.int_data_.at(int_data_offset));
-        int_data_offset++;
+                 && (array_view<int64_t>(ptr_idx)
+                     == other.array_view<int64_t>(ptr_idx));
       } else if (param.type == base_type::character) {
         all_eq = all_eq
-                 && (char_data_.at(char_data_offset)
-                     == other.char_data_.at(char_data_offset));
-        char_data_offset++;
+                 && (array_view<char>(ptr_idx)
+                     == other.array_view<char>(ptr_idx));
       } else if (param.type == base_type::floating) {
         all_eq = all_eq
                  && approx_equal(
-                     float_data_.at(float_data_offset),
-                     other.float_data_.at(float_data_offset));
-        float_data_offset++;
+                     array_view<float>(ptr_idx),
+                     other.array_view<float>(ptr_idx));
       }
+
+      ptr_idx++;
     }
   }
 
@@ -2,10 +2,17 @@
 #include <support/call_wrapper.h>
 #include <support/llvm_cloning.h>
 #include <support/thread_context.h>
+#include <support/watchdog.h>
+
+#include <llvm/ADT/SetVector.h>
+#include <llvm/Analysis/CFG.h>
 
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
 #include <llvm/IR/Verifier.h>
 
+#include <utility>
+
 using namespace props;
 using namespace support;
 
@@ -30,35 +37,85 @@ signature get_sig(Module const& mod, StringRef name)
   return *sig;
 }
 
+/**
+ * Insert a check of the interrupt flag at the start of the function, and at the
+ * head of every loop. Each check block is split after its PHI nodes, so that
+ * the check runs on every entry to the block (in particular, once for each
+ * back-edge taken).
+ */
+void add_interrupt_checks(Function& fn, GlobalVariable* flag)
+{
+  auto& ctx = fn.getContext();
+
+  auto back_edges
+      = SmallVector<std::pair<BasicBlock const*, BasicBlock const*>, 8> {};
+  FindFunctionBackedges(fn, back_edges);
+
+  auto headers = SetVector<BasicBlock*> {};
+  headers.insert(&fn.getEntryBlock());
+  for (auto [from, to] : back_edges) {
+    headers.insert(const_cast<BasicBlock*>(to));
+  }
+
+  // Interrupted executions return a null constant - the actual value should
+  // never be used.
+  auto exit_block = BasicBlock::Create(ctx, "interrupt.exit", &fn);
+  auto B = IRBuilder<>(exit_block);
+
+  auto ret_ty = fn.getReturnType();
+  if (ret_ty->isVoidTy()) {
+    B.CreateRetVoid();
+  } else {
+    B.CreateRet(Constant::getNullValue(ret_ty));
+  }
+
+  for (auto bb : headers) {
+    // Allocas stay in the entry block so that they remain static.
+    auto split = bb->getFirstInsertionPt();
+    while (isa<AllocaInst>(*split)) {
+      ++split;
+    }
+
+    auto body = bb->splitBasicBlock(split, bb->getName() + ".body");
+    bb->getTerminator()->eraseFromParent();
+
+    // The load needs to be volatile so that it can't be hoisted out of loops.
+    B.SetInsertPoint(bb);
+    auto load = B.CreateLoad(B.getInt8Ty(), flag);
+    load->setVolatile(true);
+
+    B.CreateCondBr(B.CreateICmpNE(load, B.getInt8(0)), exit_block, body);
+  }
+}
+
 } // namespace
 
 call_wrapper::call_wrapper(
     signature sig, llvm::Module const& mod, StringRef name)
     : signature_(sig)
+    , name_(name)
+    , module_(copy_module_to(thread_context::get(), mod))
+    , mappings_ {}
+    , session_(&jit_session::get())
+    , tracker_(nullptr)
+    , wrapper_symbol_ {}
+    , batch_symbol_ {}
+    , entry_(nullptr)
+    , batch_entry_(nullptr)
+    , own_interrupt_(nullptr)
+    , interrupt_(nullptr)
 {
-  auto mod_copy = copy_module_to(thread_context::get(), mod);
+  module_->setDataLayout(session_->data_layout());
 
-  impl_ = mod_copy->getFunction(name);
+  impl_ = module_->getFunction(name);
   if (!impl_) {
-    impl_ = sig.create_function(*mod_copy);
+    impl_ = sig.create_function(*module_);
   }
 
-  wrapper_ = build_wrapper_function(*mod_copy, impl_);
+  wrapper_ = build_wrapper_function(*module_, impl_);
+  batch_wrapper_ = build_batch_function(*module_, wrapper_);
 
-  auto topts = TargetOptions {};
-  std::string err;
-
-  verifyModule(*mod_copy, &llvm::errs());
-
-  auto eb = llvm::EngineBuilder {std::move(mod_copy)};
-  eb.setErrorStr(&err);
-  eb.setEngineKind(EngineKind::JIT);
-  eb.setTargetOptions(topts);
-  engine_.reset(eb.create());
-
-  if (!engine_) {
-    throw std::runtime_error("Engine creation failed: " + err);
-  }
+  verifyModule(*module_, &llvm::errs());
 }
 
 call_wrapper::call_wrapper(Module const& mod, StringRef name)
@@ -77,7 +134,99 @@ call_wrapper::call_wrapper(
     : call_wrapper(sig, mod, name)
 {
   auto sym = dl.raw_symbol(std::string(name));
-  engine_->addGlobalMapping(impl_, sym);
+  add_global_mapping(impl_, sym);
+}
+
+call_wrapper::call_wrapper(call_wrapper&& other)
+    : signature_(std::move(other.signature_))
+    , name_(std::move(other.name_))
+    , module_(std::move(other.module_))
+    , impl_(std::exchange(other.impl_, nullptr))
+    , wrapper_(std::exchange(other.wrapper_, nullptr))
+    , batch_wrapper_(std::exchange(other.batch_wrapper_, nullptr))
+    , mappings_(std::move(other.mappings_))
+    , session_(other.session_)
+    , tracker_(std::move(other.tracker_))
+    , wrapper_symbol_(std::move(other.wrapper_symbol_))
+    , batch_symbol_(std::move(other.batch_symbol_))
+    , entry_(std::exchange(other.entry_, nullptr))
+    , batch_entry_(std::exchange(other.batch_entry_, nullptr))
+    , own_interrupt_(std::move(other.own_interrupt_))
+    , interrupt_(std::exchange(other.interrupt_, nullptr))
+{
+  other.tracker_ = nullptr;
+}
+
+call_wrapper::~call_wrapper()
+{
+  if (tracker_) {
+    session_->remove(tracker_);
+  }
+}
+
+bool call_wrapper::compiled() const { return module_ == nullptr; }
+
+Function* call_wrapper::implementation() const
+{
+  assertion(
+      module_ != nullptr,
+      "Can't access implementation of {} after it has been compiled", name_);
+  return impl_;
+}
+
+void call_wrapper::add_global_mapping(GlobalValue const* gv, void* addr)
+{
+  assertion(
+      module_ != nullptr,
+      "Can't add mappings to {} after it has been compiled", name_);
+  mappings_[gv] = addr;
+}
+
+void call_wrapper::finalize()
+{
+  if (module_) {
+    // Every wrapper in this thread shares a single JIT symbol namespace, so the
+    // externally visible symbols in this module need to be made unique before
+    // they're added. Declarations that we don't have a mapping for are left
+    // alone so that they resolve to symbols in the host process.
+    auto suffix = "." + std::to_string(session_->next_id());
+
+    for (auto& gv : module_->global_values()) {
+      auto is_mapped = mappings_.find(&gv) != mappings_.end();
+
+      // Mappings take priority over any definition that the module already has
+      // for the same symbol.
+      if (is_mapped) {
+        if (auto func = dyn_cast<Function>(&gv)) {
+          func->deleteBody();
+        } else if (auto var = dyn_cast<GlobalVariable>(&gv)) {
+          var->setInitializer(nullptr);
+        }
+      }
+
+      if (gv.hasLocalLinkage() || gv.getName().startswith("llvm.")
+          || (gv.isDeclaration() && !is_mapped)) {
+        continue;
+      }
+
+      gv.setName(gv.getName() + suffix);
+    }
+
+    auto named_mappings = std::map<std::string, void*> {};
+    for (auto [gv, addr] : mappings_) {
+      named_mappings[gv->getName().str()] = addr;
+    }
+
+    wrapper_symbol_ = wrapper_->getName().str();
+    batch_symbol_ = batch_wrapper_->getName().str();
+
+    impl_ = nullptr;
+    wrapper_ = nullptr;
+    batch_wrapper_ = nullptr;
+    mappings_.clear();
+
+    tracker_ = session_->add_module(std::move(module_), named_mappings);
+  }
 }
 
 call_builder call_wrapper::get_builder() const
@@ -85,18 +234,32 @@ call_builder call_wrapper::get_builder() const
   return call_builder(signature_);
 }
 
+call_wrapper::raw_function call_wrapper::resolve_entry()
+{
+  finalize();
+  entry_ = reinterpret_cast<raw_function>(session_->lookup(wrapper_symbol_));
+  return entry_;
+}
+
+call_wrapper::raw_batch_function call_wrapper::resolve_batch_entry()
+{
+  finalize();
+  batch_entry_ = reinterpret_cast<raw_batch_function>(
+      session_->lookup(batch_symbol_));
+  return batch_entry_;
+}
+
 uint64_t call_wrapper::call(call_builder& build)
 {
-  auto [rv, _] = call_timed(build);
-  return rv;
+  return raw_entry()(build.args());
 }
 
 std::pair<uint64_t, std::chrono::nanoseconds>
 call_wrapper::call_timed(call_builder& build)
 {
-  auto addr = engine_->getPointerToFunction(wrapper_);
-  engine_->finalizeObject();
-  auto jit_fn = reinterpret_cast<uint64_t (*)(uint8_t*)>(addr);
+  // Resolve the entry point and argument data before starting the clock so
+  // that the measured time is only the execution of the wrapped function.
+  auto jit_fn = raw_entry();
   auto args = build.args();
 
   auto clk = std::chrono::steady_clock {};
@@ -108,6 +271,73 @@ call_wrapper::call_timed(call_builder& build)
   return {rv, end - start};
 }
 
+void call_wrapper::enable_interrupts(std::atomic<bool>* flag)
+{
+  static_assert(
+      sizeof(std::atomic<bool>) == 1 && std::atomic<bool>::is_always_lock_free,
+      "Interrupt flags are read from JIT code as single bytes");
+
+  assertion(
+      module_ != nullptr,
+      "Can't add interrupts to {} after it has been compiled", name_);
+  assumes(!interrupt_, "Interrupts are already enabled for {}", name_);
+  assumes(
+      !impl_->isDeclaration(),
+      "Can't add interrupts to {} - it isn't defined in IR", name_);
+
+  auto global = new GlobalVariable(
+      *module_, IntegerType::get(module_->getContext(), 8), false,
+      GlobalValue::ExternalLinkage, nullptr, "interrupt");
+  add_global_mapping(global, static_cast<void*>(flag));
+
+  add_interrupt_checks(*impl_, global);
+  interrupt_ = flag;
+}
+
+void call_wrapper::enable_interrupts()
+{
+  own_interrupt_ = std::make_unique<std::atomic<bool>>(false);
+  enable_interrupts(own_interrupt_.get());
+}
+
+std::optional<uint64_t> call_wrapper::call_with_timeout(
+    call_builder& build, std::chrono::nanoseconds limit)
+{
+  assumes(
+      own_interrupt_,
+      "Interrupts must be enabled for {} to call it with a timeout", name_);
+
+  auto flag = own_interrupt_.get();
+  flag->store(false);
+
+  auto& dog = watchdog::get();
+  auto h = dog.schedule_after(limit, [flag] { flag->store(true); });
+
+  auto ret = call(build);
+
+  if (!dog.cancel(h)) {
+    return std::nullopt;
+  }
+
+  return ret;
+}
+
+std::vector<uint64_t>
+call_wrapper::call_batch(MutableArrayRef<call_builder> builders)
+{
+  auto args = std::vector<uint8_t*> {};
+  args.reserve(builders.size());
+
+  for (auto& build : builders) {
+    args.push_back(build.args());
+  }
+
+  auto results = std::vector<uint64_t>(builders.size(), 0);
+  raw_batch_entry()(args.data(), results.data(), args.size());
+
+  return results;
+}
+
 size_t call_wrapper::marshalled_size(llvm::Type const* type) const
 {
   if (type->isFloatTy()) {
@@ -141,27 +371,17 @@ Function* call_wrapper::build_wrapper_function(Module& mod, Function* fn) const
 
   auto call_args = std::vector<Value*> {};
 
+  // Arguments are packed without any padding, so each one is loaded as a
+  // whole value with an alignment of 1 rather than being assembled from
+  // individual bytes.
   for (auto it = fn->arg_begin(); it != fn->arg_end(); ++it) {
     auto arg_type = it->getType();
 
-    auto size = marshalled_size(arg_type);
-    auto vec = make_vector(B, size);
-
-    for (auto i = 0u; i < size; ++i) {
-      auto gep = B.CreateGEP(arg_data, B.getInt64(offset));
-      auto val = B.CreateLoad(gep);
-      vec = B.CreateInsertElement(vec, val, i);
-      ++offset;
-    }
+    auto gep = B.CreateGEP(byte_t, arg_data, B.getInt64(offset));
+    auto cast = B.CreateBitCast(gep, arg_type->getPointerTo());
+    call_args.push_back(B.CreateAlignedLoad(arg_type, cast, MaybeAlign(1)));
 
-    if (arg_type->isPointerTy()) {
-      auto cast = B.CreateBitCast(vec, IntegerType::get(ctx, 64));
-      auto ptr = B.CreateIntToPtr(cast, arg_type);
-      call_args.push_back(ptr);
-    } else {
-      auto cast = B.CreateBitCast(vec, it->getType());
-      call_args.push_back(cast);
-    }
+    offset += marshalled_size(arg_type);
   }
 
   auto call = B.CreateCall(fn, call_args);
@@ -174,9 +394,50 @@ Function* call_wrapper::build_wrapper_function(Module& mod, Function* fn) const
   return new_fn;
 }
 
-std::string call_wrapper::name() const
+Function*
+call_wrapper::build_batch_function(Module& mod, Function* wrapper) const
 {
-  return std::string(implementation()->getName());
+  auto& ctx = thread_context::get();
+
+  auto name = wrapper->getName().str() + "_batch";
+  auto i64_t = IntegerType::get(ctx, 64);
+  auto pack_t = IntegerType::get(ctx, 8)->getPointerTo();
+  auto fn_ty = FunctionType::get(
+      Type::getVoidTy(ctx),
+      {pack_t->getPointerTo(), i64_t->getPointerTo(), i64_t}, false);
+
+  auto new_fn
+      = Function::Create(fn_ty, GlobalValue::ExternalLinkage, name, &mod);
+
+  auto packs = new_fn->getArg(0);
+  auto results = new_fn->getArg(1);
+  auto count = new_fn->getArg(2);
+
+  auto entry = BasicBlock::Create(ctx, "entry", new_fn);
+  auto loop = BasicBlock::Create(ctx, "loop", new_fn);
+  auto exit = BasicBlock::Create(ctx, "exit", new_fn);
+
+  auto B = IRBuilder<>(entry);
+  B.CreateCondBr(B.CreateICmpEQ(count, B.getInt64(0)), exit, loop);
+
+  B.SetInsertPoint(loop);
+  auto idx = B.CreatePHI(i64_t, 2);
+  idx->addIncoming(B.getInt64(0), entry);
+
+  auto pack = B.CreateLoad(pack_t, B.CreateGEP(pack_t, packs, idx));
+  auto ret = B.CreateCall(wrapper, {pack});
+  B.CreateStore(ret, B.CreateGEP(i64_t, results, idx));
+
+  auto next = B.CreateAdd(idx, B.getInt64(1));
+  idx->addIncoming(next, loop);
+  B.CreateCondBr(B.CreateICmpULT(next, count), loop, exit);
+
+  B.SetInsertPoint(exit);
+  B.CreateRetVoid();
+
+  return new_fn;
 }
 
+std::string call_wrapper::name() const { return name_; }
+
 } // namespace support
@@ -0,0 +1,367 @@
+#include <support/assert.h>
+#include <support/example_file.h>
+
+#include <fmt/format.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace support {
+
+namespace {
+
+constexpr size_t word = sizeof(uint64_t);
+
+// Offset of the count field, which the writer fills in when it's closed.
+constexpr size_t count_offset = sizeof(example_file::magic) + 2 * sizeof(uint32_t);
+constexpr size_t header_size = count_offset + sizeof(uint64_t);
+
+size_t padded(size_t n) { return (n + word - 1) / word * word; }
+
+example_file_error file_error(std::string const& what, std::string const& path)
+{
+  return example_file_error(
+      fmt::format("{} ({}): {}", what, path, std::strerror(errno)));
+}
+
+} // namespace
+
+// Writer
+
+example_writer::example_writer(std::string const& path, props::signature sig)
+    : signature_(sig)
+    , file_(nullptr)
+    , owns_file_(path != "-")
+    , written_(0)
+    , buffer_ {}
+{
+  file_ = owns_file_ ? std::fopen(path.c_str(), "wb") : stdout;
+  if (!file_) {
+    throw file_error("Couldn't open example file for writing", path);
+  }
+
+  auto sig_str = fmt::format("{}", signature_);
+
+  put_bytes(example_file::magic, sizeof(example_file::magic));
+  put(example_file::version);
+  put(static_cast<uint32_t>(sig_str.size()));
+  put(owns_file_ ? uint64_t {0} : example_file::unknown_count);
+
+  put_bytes(sig_str.data(), sig_str.size());
+  buffer_.resize(padded(buffer_.size()), 0);
+
+  std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+}
+
+example_writer::~example_writer()
+{
+  if (file_) {
+    try {
+      close();
+    } catch (example_file_error const&) {
+    }
+  }
+}
+
+template <typename T>
+void example_writer::put(T val)
+{
+  put_bytes(&val, sizeof(T));
+}
+
+void example_writer::put_bytes(void const* data, size_t n)
+{
+  auto bytes = static_cast<uint8_t const*>(data);
+  buffer_.insert(buffer_.end(), bytes, bytes + n);
+}
+
+void example_writer::write(
+    call_builder const& input, call_builder const& output,
+    uint64_t return_value)
+{
+  assumes(file_ != nullptr, "Can't write to a closed example file");
+  assumes(
+      input.ready() && output.ready(),
+      "Examples must have every argument set to be written");
+  assumes(
+      input.signature() == signature_ && output.signature() == signature_,
+      "Example signature must match the file's signature");
+
+  buffer_.clear();
+
+  auto put_array = [this](auto vv) {
+    put(static_cast<uint64_t>(vv.size()));
+    put_bytes(vv.data(), vv.size() * sizeof(vv[0]));
+    buffer_.resize(padded(buffer_.size()), 0);
+  };
+
+  input.visit_args(
+      [this](auto sv) {
+        auto slot = uint64_t {0};
+        std::memcpy(&slot, &sv, sizeof(sv));
+        put(slot);
+      },
+      put_array);
+
+  output.visit_pointer_args(put_array);
+  put(return_value);
+
+  if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+    throw example_file_error("Couldn't write example to file");
+  }
+
+  ++written_;
+}
+
+void example_writer::close()
+{
+  if (!file_) {
+    return;
+  }
+
+  auto file = file_;
+  file_ = nullptr;
+
+  auto ok = std::fflush(file) == 0;
+
+  if (owns_file_) {
+    auto count = static_cast<uint64_t>(written_);
+
+    ok = ok && std::fseek(file, count_offset, SEEK_SET) == 0
+         && std::fwrite(&count, sizeof(count), 1, file) == 1;
+    ok = (std::fclose(file) == 0) && ok;
+  }
+
+  if (!ok) {
+    throw example_file_error("Couldn't finish writing example file");
+  }
+}
+
+size_t example_writer::written() const { return written_; }
+
+// Reader
+
+example_reader::example_reader(std::string const& path)
+    : path_(path)
+    , data_(nullptr)
+    , size_(0)
+    , signature_ {}
+    , offsets_ {}
+{
+  auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw file_error("Couldn't open example file", path);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw file_error("Couldn't stat example file", path);
+  }
+
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ < header_size) {
+    close(fd);
+    throw example_file_error(
+        fmt::format("Example file is too small to be valid ({})", path));
+  }
+
+  auto mem = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (mem == MAP_FAILED) {
+    throw file_error("Couldn't map example file", path);
+  }
+
+  data_ = static_cast<uint8_t const*>(mem);
+
+  // From here on, the mapping needs to be released if anything goes wrong.
+  try {
+    if (std::memcmp(data_, example_file::magic, sizeof(example_file::magic))
+        != 0) {
+      throw example_file_error(
+          fmt::format("Not a recorded example file ({})", path));
+    }
+
+    auto ver = uint32_t {0};
+    auto sig_len = uint32_t {0};
+    std::memcpy(&ver, data_ + sizeof(example_file::magic), sizeof(ver));
+    std::memcpy(
+        &sig_len, data_ + sizeof(example_file::magic) + sizeof(ver),
+        sizeof(sig_len));
+
+    if (ver != example_file::version) {
+      throw example_file_error(fmt::format(
+          "Unsupported example file version {} ({})", ver, path));
+    }
+
+    auto count = read_word(count_offset);
+    auto pos = header_size + padded(sig_len);
+
+    if (pos > size_) {
+      throw example_file_error(
+          fmt::format("Truncated example file header ({})", path));
+    }
+
+    signature_ = props::signature::parse(std::string_view(
+        reinterpret_cast<char const*>(data_ + header_size), sig_len));
+
+    // Indexing the records validates their lengths as well, so that decoding
+    // them later can't run off the end of the mapping.
+    while (pos < size_
+           && (count == example_file::unknown_count
+               || offsets_.size() < count)) {
+      offsets_.push_back(pos);
+      pos = decode(pos, false, nullptr, nullptr);
+    }
+
+    if (count != example_file::unknown_count && offsets_.size() != count) {
+      throw example_file_error(fmt::format(
+          "Example file has {} records, but its header says {} ({})",
+          offsets_.size(), count, path));
+    }
+  } catch (...) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    throw;
+  }
+}
+
+example_reader::~example_reader()
+{
+  munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+uint64_t example_reader::read_word(size_t offset) const
+{
+  if (offset > size_ || size_ - offset < word) {
+    throw example_file_error(
+        fmt::format("Truncated record in example file ({})", path_));
+  }
+
+  auto ret = uint64_t {0};
+  std::memcpy(&ret, data_ + offset, word);
+  return ret;
+}
+
+size_t example_reader::decode(
+    size_t offset, bool after, call_builder* build,
+    uint64_t* return_value) const
+{
+  using props::base_type;
+
+  auto const& params = signature_.parameters;
+  auto pos = offset;
+
+  auto skip_array = [&](props::param const& p) {
+    auto n = read_word(pos);
+    auto elt = base_type_size(p.type);
+
+    if (n > (size_ - pos - word) / elt) {
+      throw example_file_error(
+          fmt::format("Truncated array in example file ({})", path_));
+    }
+
+    auto start = pos + word;
+    pos = start + padded(n * elt);
+    return start;
+  };
+
+  // Find where each argument's data starts before decoding any of them, as the
+  // arrays after the call are stored separately from the scalars.
+  auto before = std::vector<size_t>(params.size());
+  for (auto i = 0u; i < params.size(); ++i) {
+    if (params[i].pointer_depth == 0) {
+      read_word(pos);
+      before[i] = pos;
+      pos += word;
+    } else {
+      before[i] = skip_array(params[i]);
+    }
+  }
+
+  auto post = std::vector<size_t> {};
+  for (auto const& p : params) {
+    if (p.pointer_depth != 0) {
+      post.push_back(skip_array(p));
+    }
+  }
+
+  auto ret = read_word(pos);
+  pos += word;
+
+  if (return_value) {
+    *return_value = ret;
+  }
+
+  if (!build) {
+    return pos;
+  }
+
+  auto ptr_idx = size_t {0};
+  for (auto i = 0u; i < params.size(); ++i) {
+    auto const& p = params[i];
+
+    if (p.pointer_depth == 0) {
+      auto field = data_ + before[i];
+
+      if (p.type == base_type::character) {
+        build->add(detail::from_bytes<char>(field));
+      } else if (p.type == base_type::integer) {
+        build->add(detail::from_bytes<int64_t>(field));
+      } else if (p.type == base_type::floating) {
+        build->add(detail::from_bytes<float>(field));
+      } else {
+        invalid_state();
+      }
+    } else {
+      auto start = after ? post[ptr_idx] : before[i];
+      auto n = static_cast<size_t>(read_word(start - word));
+      auto field = data_ + start;
+
+      if (p.type == base_type::character) {
+        build->add(llvm::ArrayRef<char>(
+            reinterpret_cast<char const*>(field), n));
+      } else if (p.type == base_type::integer) {
+        build->add(llvm::ArrayRef<int64_t>(
+            reinterpret_cast<int64_t const*>(field), n));
+      } else if (p.type == base_type::floating) {
+        build->add(llvm::ArrayRef<float>(
+            reinterpret_cast<float const*>(field), n));
+      } else {
+        invalid_state();
+      }
+
+      ++ptr_idx;
+    }
+  }
+
+  return pos;
+}
+
+props::signature const& example_reader::signature() const
+{
+  return signature_;
+}
+
+size_t example_reader::size() const { return offsets_.size(); }
+
+call_builder example_reader::input(size_t n) const
+{
+  auto build = call_builder(signature_);
+  decode(offsets_.at(n), false, &build, nullptr);
+  return build;
+}
+
+output_example example_reader::output(size_t n) const
+{
+  auto ret = output_example {0, call_builder(signature_)};
+  decode(offsets_.at(n), true, &ret.output_args, &ret.return_value);
+  return ret;
+}
+
+} // namespace support
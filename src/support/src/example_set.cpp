@@ -0,0 +1,181 @@
+#include <support/assert.h>
+#include <support/example_set.h>
+
+#include <algorithm>
+#include <optional>
+
+using namespace props;
+
+namespace support {
+
+example_set::example_set(props::signature sig)
+    : signature_(sig)
+    , examples_ {}
+    , order_ {}
+    , scratch_(sig)
+    , actual_ {0, call_builder(sig)}
+{
+}
+
+void example_set::generate(
+    call_wrapper& ref, argument_generator gen, size_t n)
+{
+  auto inputs = std::vector<call_builder> {};
+  inputs.reserve(n);
+
+  for (auto i = 0u; i < n; ++i) {
+    auto input = ref.get_builder();
+    gen.gen_args(input);
+    inputs.push_back(std::move(input));
+  }
+
+  // The reference is called on copies of the inputs, all in one batch.
+  auto outputs = inputs;
+  auto returns = ref.call_batch(outputs);
+
+  examples_.reserve(examples_.size() + n);
+  order_.reserve(order_.size() + n);
+
+  for (auto i = 0u; i < n; ++i) {
+    order_.push_back(examples_.size());
+    examples_.push_back(
+        {std::move(inputs[i]), {returns[i], std::move(outputs[i])}});
+  }
+}
+
+void example_set::add(call_wrapper& ref, call_builder input)
+{
+  assumes(
+      input.signature() == signature_,
+      "Example signature must match the set's signature");
+
+  auto output = input;
+  auto ret = ref.call(output);
+
+  order_.push_back(examples_.size());
+  examples_.push_back({std::move(input), {ret, std::move(output)}});
+}
+
+void example_set::load(example_reader const& file)
+{
+  assumes(
+      file.signature() == signature_,
+      "Recorded examples must have the set's signature");
+
+  examples_.reserve(examples_.size() + file.size());
+  order_.reserve(order_.size() + file.size());
+
+  for (auto i = 0u; i < file.size(); ++i) {
+    order_.push_back(examples_.size());
+    examples_.push_back({file.input(i), file.output(i)});
+  }
+}
+
+bool example_set::check(call_wrapper& cand)
+{
+  return check_with(
+      [&](call_builder& build) -> std::optional<uint64_t> {
+        return cand.call(build);
+      });
+}
+
+bool example_set::check(sandbox& cand)
+{
+  return check_with(
+      [&](call_builder& build) -> std::optional<uint64_t> {
+        auto result = cand.call(build);
+        if (!result.ok()) {
+          return std::nullopt;
+        }
+
+        return result.return_value;
+      });
+}
+
+template <typename CallF>
+bool example_set::check_with(CallF&& call)
+{
+  for (auto it = order_.begin(); it != order_.end(); ++it) {
+    if (!check_one(call, examples_[*it])) {
+      std::rotate(order_.begin(), it, std::next(it));
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename CallF>
+bool example_set::check_one(CallF&& call, example& ex)
+{
+  // Without pointer arguments, the candidate can't modify its argument pack
+  // so we don't need to take a copy of it to call with.
+  if (!signature_.accepts_pointer()) {
+    return call(ex.input) == ex.output.return_value;
+  }
+
+  scratch_ = ex.input;
+  auto ret = call(scratch_);
+
+  return ret == ex.output.return_value && scratch_ == ex.output.output_args;
+}
+
+int64_t example_set::error(call_wrapper& cand, error_function const& err)
+{
+  auto total = error_with(
+      [&](call_builder& build) -> std::optional<uint64_t> {
+        return cand.call(build);
+      },
+      err);
+
+  return *total;
+}
+
+std::optional<int64_t>
+example_set::error(sandbox& cand, error_function const& err)
+{
+  return error_with(
+      [&](call_builder& build) -> std::optional<uint64_t> {
+        auto result = cand.call(build);
+        if (!result.ok()) {
+          return std::nullopt;
+        }
+
+        return result.return_value;
+      },
+      err);
+}
+
+template <typename CallF>
+std::optional<int64_t>
+example_set::error_with(CallF&& call, error_function const& err)
+{
+  auto total = int64_t {0};
+
+  for (auto const& ex : examples_) {
+    actual_.output_args = ex.input;
+
+    auto ret = call(actual_.output_args);
+    if (!ret) {
+      return std::nullopt;
+    }
+
+    actual_.return_value = *ret;
+    total += err(ex.output, actual_);
+  }
+
+  return total;
+}
+
+std::vector<example_set::example> const& example_set::examples() const
+{
+  return examples_;
+}
+
+size_t example_set::size() const { return examples_.size(); }
+
+bool example_set::empty() const { return examples_.empty(); }
+
+props::signature const& example_set::signature() const { return signature_; }
+
+} // namespace support
@@ -0,0 +1,355 @@
+#include <support/fingerprint.h>
+
+#include <llvm/ADT/DepthFirstIterator.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/InstrTypes.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Transforms/Utils/Local.h>
+
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace llvm;
+
+namespace support {
+
+namespace {
+
+// Names of types and globals are uniqued within an LLVM context or module by
+// adding a ".N" suffix, which depends on what else has been created there.
+StringRef strip_suffix(StringRef name)
+{
+  auto dot = name.rfind('.');
+  if (dot == StringRef::npos || dot + 1 == name.size()) {
+    return name;
+  }
+
+  auto digits = name.substr(dot + 1);
+  if (digits.find_first_not_of("0123456789") != StringRef::npos) {
+    return name;
+  }
+
+  return name.substr(0, dot);
+}
+
+uint64_t mix(uint64_t z)
+{
+  // The splitmix64 finaliser; every input bit affects every output bit.
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+class fingerprinter {
+public:
+  explicit fingerprinter(Function const& fn);
+
+  uint64_t result() const { return mix(hash_); }
+
+private:
+  void add(uint64_t v) { hash_ = mix(hash_ ^ mix(v + 0x9e3779b97f4a7c15)); }
+
+  void add(StringRef str)
+  {
+    auto view = std::string_view(str.data(), str.size());
+    add(std::hash<std::string_view> {}(view));
+    add(str.size());
+  }
+
+  void add(APInt const& val)
+  {
+    add(val.getBitWidth());
+    for (auto i = 0u; i < val.getNumWords(); ++i) {
+      add(val.getRawData()[i]);
+    }
+  }
+
+  void add_indices(ArrayRef<unsigned> indices)
+  {
+    add(indices.size());
+    for (auto idx : indices) {
+      add(idx);
+    }
+  }
+
+  void add_memory(bool is_volatile, AtomicOrdering order, SyncScope::ID scope)
+  {
+    add(is_volatile);
+    add(static_cast<uint64_t>(order));
+    add(scope);
+  }
+
+  void add_type(Type const*);
+  void add_value(Value const*);
+  void add_instruction(Instruction const&);
+  void add_call(CallBase const&);
+
+  uint64_t hash_ = 0;
+
+  std::unordered_map<BasicBlock const*, uint64_t> blocks_ = {};
+  std::unordered_map<Instruction const*, uint64_t> insts_ = {};
+};
+
+fingerprinter::fingerprinter(Function const& fn)
+{
+  add_type(fn.getFunctionType());
+
+  if (fn.isDeclaration()) {
+    return;
+  }
+
+  auto reachable = SmallPtrSet<BasicBlock const*, 16> {};
+  for (auto bb : depth_first(&fn.getEntryBlock())) {
+    reachable.insert(bb);
+  }
+
+  // Anything that can't be removed when unused is live, along with everything
+  // that the live instructions use.
+  auto live = SmallPtrSet<Instruction const*, 32> {};
+  auto work = std::vector<Instruction const*> {};
+
+  for (auto const& bb : fn) {
+    if (reachable.count(&bb) == 0) {
+      continue;
+    }
+
+    for (auto const& inst : bb) {
+      // The check doesn't modify the instruction, despite its signature.
+      if (!wouldInstructionBeTriviallyDead(const_cast<Instruction*>(&inst))) {
+        live.insert(&inst);
+        work.push_back(&inst);
+      }
+    }
+  }
+
+  while (!work.empty()) {
+    auto inst = work.back();
+    work.pop_back();
+
+    for (auto const& op : inst->operands()) {
+      auto op_inst = dyn_cast<Instruction>(op.get());
+      if (op_inst && reachable.count(op_inst->getParent()) > 0
+          && live.insert(op_inst).second) {
+        work.push_back(op_inst);
+      }
+    }
+  }
+
+  // Number everything before hashing, as phis can refer forwards.
+  for (auto const& bb : fn) {
+    if (reachable.count(&bb) > 0) {
+      blocks_.try_emplace(&bb, blocks_.size());
+
+      for (auto const& inst : bb) {
+        if (live.count(&inst) > 0) {
+          insts_.try_emplace(&inst, insts_.size());
+        }
+      }
+    }
+  }
+
+  for (auto const& bb : fn) {
+    if (reachable.count(&bb) == 0) {
+      continue;
+    }
+
+    add(blocks_.at(&bb));
+
+    for (auto const& inst : bb) {
+      if (live.count(&inst) > 0) {
+        add_instruction(inst);
+      }
+    }
+  }
+}
+
+void fingerprinter::add_type(Type const* ty)
+{
+  add(ty->getTypeID());
+
+  if (auto st = dyn_cast<StructType>(ty)) {
+    if (st->hasName()) {
+      add(strip_suffix(st->getName()));
+      return;
+    }
+
+    add(st->isPacked());
+  } else if (auto it = dyn_cast<IntegerType>(ty)) {
+    add(it->getBitWidth());
+  } else if (auto pt = dyn_cast<PointerType>(ty)) {
+    add(pt->getAddressSpace());
+  } else if (auto at = dyn_cast<ArrayType>(ty)) {
+    add(at->getNumElements());
+  } else if (auto vt = dyn_cast<VectorType>(ty)) {
+    add(vt->getElementCount().getKnownMinValue());
+  } else if (auto ft = dyn_cast<FunctionType>(ty)) {
+    add(ft->isVarArg());
+  }
+
+  add(ty->getNumContainedTypes());
+  for (auto sub : ty->subtypes()) {
+    add_type(sub);
+  }
+}
+
+void fingerprinter::add_value(Value const* val)
+{
+  add(val->getValueID());
+
+  if (auto arg = dyn_cast<Argument>(val)) {
+    add(arg->getArgNo());
+    return;
+  }
+
+  if (auto bb = dyn_cast<BasicBlock>(val)) {
+    auto it = blocks_.find(bb);
+    add(it == blocks_.end() ? ~uint64_t {0} : it->second);
+    return;
+  }
+
+  if (auto inst = dyn_cast<Instruction>(val)) {
+    // Live instructions only ever use live instructions; anything else is in
+    // an unreachable block.
+    auto it = insts_.find(inst);
+    add(it == insts_.end() ? ~uint64_t {0} : it->second);
+    return;
+  }
+
+  add_type(val->getType());
+
+  if (auto gv = dyn_cast<GlobalValue>(val)) {
+    add(strip_suffix(gv->getName()));
+  } else if (auto ci = dyn_cast<ConstantInt>(val)) {
+    add(ci->getValue());
+  } else if (auto cf = dyn_cast<ConstantFP>(val)) {
+    add(cf->getValueAPF().bitcastToAPInt());
+  } else if (auto cds = dyn_cast<ConstantDataSequential>(val)) {
+    add(cds->getRawDataValues());
+  } else if (auto ce = dyn_cast<ConstantExpr>(val)) {
+    add(ce->getOpcode());
+    for (auto const& op : ce->operands()) {
+      add_value(op.get());
+    }
+  } else if (auto agg = dyn_cast<ConstantAggregate>(val)) {
+    for (auto const& op : agg->operands()) {
+      add_value(op.get());
+    }
+  }
+}
+
+void fingerprinter::add_instruction(Instruction const& inst)
+{
+  add(inst.getOpcode());
+  add_type(inst.getType());
+
+  // Flags like nsw / exact / fast-math.
+  add(inst.getRawSubclassOptionalData());
+
+  // Anything stored on the instruction itself rather than as an operand.
+  if (auto cmp = dyn_cast<CmpInst>(&inst)) {
+    add(cmp->getPredicate());
+  } else if (auto gep = dyn_cast<GetElementPtrInst>(&inst)) {
+    add_type(gep->getSourceElementType());
+  } else if (auto alloca = dyn_cast<AllocaInst>(&inst)) {
+    add_type(alloca->getAllocatedType());
+    add(alloca->getAlign().value());
+  } else if (auto call = dyn_cast<CallBase>(&inst)) {
+    add_call(*call);
+  } else if (auto phi = dyn_cast<PHINode>(&inst)) {
+    for (auto bb : phi->blocks()) {
+      add_value(bb);
+    }
+  } else if (auto load = dyn_cast<LoadInst>(&inst)) {
+    add_memory(load->isVolatile(), load->getOrdering(), load->getSyncScopeID());
+    add(load->getAlign().value());
+  } else if (auto store = dyn_cast<StoreInst>(&inst)) {
+    add_memory(
+        store->isVolatile(), store->getOrdering(), store->getSyncScopeID());
+    add(store->getAlign().value());
+  } else if (auto rmw = dyn_cast<AtomicRMWInst>(&inst)) {
+    add(rmw->getOperation());
+    add_memory(rmw->isVolatile(), rmw->getOrdering(), rmw->getSyncScopeID());
+  } else if (auto cas = dyn_cast<AtomicCmpXchgInst>(&inst)) {
+    add(cas->isWeak());
+    add(static_cast<uint64_t>(cas->getFailureOrdering()));
+    add_memory(
+        cas->isVolatile(), cas->getSuccessOrdering(), cas->getSyncScopeID());
+  } else if (auto fence = dyn_cast<FenceInst>(&inst)) {
+    add_memory(false, fence->getOrdering(), fence->getSyncScopeID());
+  } else if (auto ev = dyn_cast<ExtractValueInst>(&inst)) {
+    add_indices(ev->getIndices());
+  } else if (auto iv = dyn_cast<InsertValueInst>(&inst)) {
+    add_indices(iv->getIndices());
+  } else if (auto shuffle = dyn_cast<ShuffleVectorInst>(&inst)) {
+    add(shuffle->getShuffleMask().size());
+    for (auto elt : shuffle->getShuffleMask()) {
+      add(static_cast<uint64_t>(static_cast<int64_t>(elt)));
+    }
+  }
+
+  add(inst.getNumOperands());
+  for (auto const& op : inst.operands()) {
+    add_value(op.get());
+  }
+}
+
+void fingerprinter::add_call(CallBase const& call)
+{
+  add_type(call.getFunctionType());
+  add(call.getCallingConv());
+
+  if (auto ci = dyn_cast<CallInst>(&call)) {
+    add(ci->getTailCallKind());
+  }
+
+  auto attrs = call.getAttributes();
+  add(StringRef(attrs.getAsString(AttributeList::FunctionIndex)));
+  add(StringRef(attrs.getAsString(AttributeList::ReturnIndex)));
+
+  for (auto i = 0u; i < call.arg_size(); ++i) {
+    add(StringRef(attrs.getAsString(AttributeList::FirstArgIndex + i)));
+  }
+}
+
+} // namespace
+
+uint64_t fingerprint(Function const& fn)
+{
+  return fingerprinter(fn).result();
+}
+
+bool fingerprint_cache::insert(uint64_t fp)
+{
+  auto lock = std::lock_guard {mutex_};
+
+  auto inserted = seen_.insert(fp).second;
+  if (!inserted) {
+    ++hits_;
+  }
+
+  return inserted;
+}
+
+bool fingerprint_cache::insert(Function const& fn)
+{
+  return insert(fingerprint(fn));
+}
+
+size_t fingerprint_cache::size() const
+{
+  auto lock = std::lock_guard {mutex_};
+  return seen_.size();
+}
+
+size_t fingerprint_cache::hits() const
+{
+  auto lock = std::lock_guard {mutex_};
+  return hits_;
+}
+
+} // namespace support
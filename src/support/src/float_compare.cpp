@@ -1,5 +1,17 @@
+#include <support/assert.h>
+#include <support/bit_cast.h>
 #include <support/float_compare.h>
 
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SUPPORT_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+using namespace llvm;
+
 namespace support {
 
 int ulp_diff(float A, float B)
@@ -9,4 +21,243 @@ int ulp_diff(float A, float B)
 
   return std::abs(a_wrap.as_int() - b_wrap.as_int());
 }
+
+namespace {
+
+/**
+ * Scalar version of the comparison predicate that every kernel implements:
+ * equal bit patterns, or same sign and within the ULP limit, or within the
+ * absolute tolerance. Values of opposite sign can only be equal by ULP if they
+ * compare equal (i.e. positive and negative zero).
+ */
+bool float_elt_equal(float a, float b, float_tolerance tol)
+{
+  auto ia = bit_cast<int32_t>(a);
+  auto ib = bit_cast<int32_t>(b);
+
+  if ((ia < 0) == (ib < 0)) {
+    if (std::abs(ia - ib) <= tol.max_ulps) {
+      return true;
+    }
+  } else if (a == b) {
+    return true;
+  }
+
+  return std::abs(a - b) <= tol.max_abs;
+}
+
+void update_max(double& max, float a, float b)
+{
+  auto err = static_cast<double>(std::abs(a - b));
+  if (err > max) {
+    max = err;
+  }
+}
+
+comparison_result compare_scalar(
+    float const* a, float const* b, size_t begin, size_t n,
+    float_tolerance tol, double max_error)
+{
+  for (auto i = begin; i < n; ++i) {
+    update_max(max_error, a[i], b[i]);
+
+    if (!float_elt_equal(a[i], b[i], tol)) {
+      return {false, i, max_error};
+    }
+  }
+
+  return {true, n, max_error};
+}
+
+#ifdef SUPPORT_X86_SIMD
+
+float horizontal_max(__m128 v)
+{
+  float lanes[4];
+  _mm_storeu_ps(lanes, v);
+  return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+}
+
+/**
+ * SSE2 is part of the x86-64 baseline, so this kernel needs no special target
+ * attributes. When a block contains a mismatch, it is re-run through the
+ * scalar kernel to find the exact index and the error up to that point.
+ */
+comparison_result
+compare_sse2(float const* a, float const* b, size_t n, float_tolerance tol)
+{
+  auto const sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  auto const max_ulps = _mm_set1_epi32(tol.max_ulps);
+  auto const max_abs = _mm_set1_ps(tol.max_abs);
+
+  auto max_acc = _mm_setzero_ps();
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    auto va = _mm_loadu_ps(a + i);
+    auto vb = _mm_loadu_ps(b + i);
+
+    auto ia = _mm_castps_si128(va);
+    auto ib = _mm_castps_si128(vb);
+
+    auto sign_diff = _mm_srai_epi32(_mm_xor_si128(ia, ib), 31);
+    auto d = _mm_sub_epi32(ia, ib);
+    auto d_sign = _mm_srai_epi32(d, 31);
+    auto abs_d = _mm_sub_epi32(_mm_xor_si128(d, d_sign), d_sign);
+
+    auto ulp_bad = _mm_or_si128(sign_diff, _mm_cmpgt_epi32(abs_d, max_ulps));
+    auto ulp_ok
+        = _mm_castsi128_ps(_mm_andnot_si128(ulp_bad, _mm_set1_epi32(-1)));
+
+    auto abs_err = _mm_and_ps(_mm_sub_ps(va, vb), sign_mask);
+    auto ok = _mm_or_ps(
+        _mm_or_ps(ulp_ok, _mm_cmpeq_ps(va, vb)),
+        _mm_cmple_ps(abs_err, max_abs));
+
+    if (_mm_movemask_ps(ok) != 0xF) {
+      return compare_scalar(a, b, i, n, tol, horizontal_max(max_acc));
+    }
+
+    max_acc = _mm_max_ps(abs_err, max_acc);
+  }
+
+  return compare_scalar(a, b, i, n, tol, horizontal_max(max_acc));
+}
+
+__attribute__((target("avx2"))) float horizontal_max(__m256 v)
+{
+  return horizontal_max(
+      _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+__attribute__((target("avx2"))) comparison_result
+compare_avx2(float const* a, float const* b, size_t n, float_tolerance tol)
+{
+  auto const sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+  auto const max_ulps = _mm256_set1_epi32(tol.max_ulps);
+  auto const max_abs = _mm256_set1_ps(tol.max_abs);
+
+  auto max_acc = _mm256_setzero_ps();
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    auto va = _mm256_loadu_ps(a + i);
+    auto vb = _mm256_loadu_ps(b + i);
+
+    auto ia = _mm256_castps_si256(va);
+    auto ib = _mm256_castps_si256(vb);
+
+    auto sign_diff = _mm256_srai_epi32(_mm256_xor_si256(ia, ib), 31);
+    auto abs_d = _mm256_abs_epi32(_mm256_sub_epi32(ia, ib));
+
+    auto ulp_bad
+        = _mm256_or_si256(sign_diff, _mm256_cmpgt_epi32(abs_d, max_ulps));
+    auto ulp_ok = _mm256_castsi256_ps(
+        _mm256_andnot_si256(ulp_bad, _mm256_set1_epi32(-1)));
+
+    auto abs_err = _mm256_and_ps(_mm256_sub_ps(va, vb), sign_mask);
+    auto ok = _mm256_or_ps(
+        _mm256_or_ps(ulp_ok, _mm256_cmp_ps(va, vb, _CMP_EQ_OQ)),
+        _mm256_cmp_ps(abs_err, max_abs, _CMP_LE_OQ));
+
+    if (_mm256_movemask_ps(ok) != 0xFF) {
+      return compare_scalar(a, b, i, n, tol, horizontal_max(max_acc));
+    }
+
+    max_acc = _mm256_max_ps(abs_err, max_acc);
+  }
+
+  return compare_scalar(a, b, i, n, tol, horizontal_max(max_acc));
+}
+
+#endif
+
+simd_level detect_simd_level()
+{
+#ifdef SUPPORT_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return simd_level::avx2;
+  }
+
+  return simd_level::sse2;
+#else
+  return simd_level::scalar;
+#endif
+}
+
+template <typename T>
+comparison_result compare_exact(ArrayRef<T> a, ArrayRef<T> b)
+{
+  auto n = std::min(a.size(), b.size());
+
+  // memcmp is already vectorised, so only fall back to an element-wise search
+  // once we know that there is a difference to report.
+  if (n == 0 || std::memcmp(a.data(), b.data(), n * sizeof(T)) == 0) {
+    return {a.size() == b.size(), n, 0.0};
+  }
+
+  auto it = std::mismatch(a.begin(), a.begin() + n, b.begin()).first;
+  auto idx = static_cast<size_t>(std::distance(a.begin(), it));
+
+  auto err = static_cast<double>(a[idx]) - static_cast<double>(b[idx]);
+  return {false, idx, std::abs(err)};
+}
+
+} // namespace
+
+simd_level best_simd_level()
+{
+  static auto const level = detect_simd_level();
+  return level;
+}
+
+comparison_result
+compare_arrays(ArrayRef<float> a, ArrayRef<float> b, float_tolerance tol)
+{
+  return compare_arrays(a, b, tol, best_simd_level());
+}
+
+comparison_result compare_arrays(
+    ArrayRef<float> a, ArrayRef<float> b, float_tolerance tol,
+    simd_level level)
+{
+  assumes(
+      level <= best_simd_level(),
+      "Can't compare using instructions not supported by this CPU");
+
+  auto n = std::min(a.size(), b.size());
+  auto result = comparison_result {true, n, 0.0};
+
+  switch (level) {
+#ifdef SUPPORT_X86_SIMD
+  case simd_level::avx2:
+    result = compare_avx2(a.data(), b.data(), n, tol);
+    break;
+  case simd_level::sse2:
+    result = compare_sse2(a.data(), b.data(), n, tol);
+    break;
+#endif
+  default:
+    result = compare_scalar(a.data(), b.data(), 0, n, tol, 0.0);
+    break;
+  }
+
+  if (result.equal && a.size() != b.size()) {
+    result.equal = false;
+  }
+
+  return result;
+}
+
+comparison_result compare_arrays(ArrayRef<int64_t> a, ArrayRef<int64_t> b)
+{
+  return compare_exact(a, b);
+}
+
+comparison_result compare_arrays(ArrayRef<char> a, ArrayRef<char> b)
+{
+  return compare_exact(a, b);
+}
+
 } // namespace support
@@ -0,0 +1,113 @@
+#include <support/jit_session.h>
+#include <support/thread_context.h>
+
+#include <llvm/ExecutionEngine/JITSymbol.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/Support/Error.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+using namespace llvm;
+
+namespace support {
+
+namespace {
+
+template <typename T>
+T unwrap(Expected<T>&& exp, std::string const& what)
+{
+  if (!exp) {
+    throw std::runtime_error(what + ": " + toString(exp.takeError()));
+  }
+
+  return std::move(*exp);
+}
+
+void unwrap(Error&& err, std::string const& what)
+{
+  if (err) {
+    throw std::runtime_error(what + ": " + toString(std::move(err)));
+  }
+}
+
+} // namespace
+
+jit_session::jit_session()
+    : jit_(unwrap(orc::LLJITBuilder().create(), "JIT creation failed"))
+    , next_id_(0)
+{
+  // Candidates and reference implementations can both make calls out to
+  // functions in the host process (libm and so on), so we need to be able to
+  // resolve those symbols as well as the ones we map explicitly.
+  auto gen = unwrap(
+      orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          data_layout().getGlobalPrefix()),
+      "Process symbol resolution failed");
+
+  jit_->getMainJITDylib().addGenerator(std::move(gen));
+}
+
+jit_session& jit_session::get()
+{
+  static auto mapping
+      = std::unordered_map<std::thread::id, std::unique_ptr<jit_session>> {};
+  static auto map_mutex = std::mutex {};
+
+  auto l = std::lock_guard {map_mutex};
+  auto id = std::this_thread::get_id();
+
+  if (mapping.find(id) == mapping.end()) {
+    mapping[id] = std::unique_ptr<jit_session>(new jit_session());
+  }
+
+  return *mapping[id];
+}
+
+DataLayout const& jit_session::data_layout() const
+{
+  return jit_->getDataLayout();
+}
+
+size_t jit_session::next_id() { return next_id_++; }
+
+orc::ResourceTrackerSP jit_session::add_module(
+    std::unique_ptr<Module>&& mod, std::map<std::string, void*> const& mappings)
+{
+  auto& dylib = jit_->getMainJITDylib();
+  auto tracker = dylib.createResourceTracker();
+
+  if (!mappings.empty()) {
+    auto symbols = orc::SymbolMap {};
+
+    for (auto const& [name, addr] : mappings) {
+      symbols[jit_->mangleAndIntern(name)] = JITEvaluatedSymbol(
+          pointerToJITTargetAddress(addr),
+          JITSymbolFlags::Exported | JITSymbolFlags::Callable);
+    }
+
+    unwrap(
+        dylib.define(orc::absoluteSymbols(std::move(symbols)), tracker),
+        "Defining symbol mappings failed");
+  }
+
+  auto tsm = orc::ThreadSafeModule(std::move(mod), thread_context::safe());
+  unwrap(jit_->addIRModule(tracker, std::move(tsm)), "Adding module failed");
+
+  return tracker;
+}
+
+void jit_session::remove(orc::ResourceTrackerSP const& tracker)
+{
+  unwrap(tracker->remove(), "Removing module failed");
+}
+
+void* jit_session::lookup(std::string const& name)
+{
+  auto sym = unwrap(jit_->lookup(name), "Symbol lookup failed");
+  return jitTargetAddressToPointer<void*>(sym.getAddress());
+}
+
+} // namespace support
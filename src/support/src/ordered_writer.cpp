@@ -0,0 +1,40 @@
+#include <support/assert.h>
+#include <support/ordered_writer.h>
+
+namespace support {
+
+ordered_writer::ordered_writer(std::FILE* out)
+    : out_(out)
+    , next_(0)
+    , pending_ {}
+    , mutex_ {}
+{
+}
+
+void ordered_writer::write(size_t index, std::string text)
+{
+  auto lock = std::lock_guard {mutex_};
+
+  assumes(
+      index >= next_ && pending_.find(index) == pending_.end(),
+      "Output chunk {} has already been written", index);
+
+  pending_.emplace(index, std::move(text));
+
+  for (auto it = pending_.begin();
+       it != pending_.end() && it->first == next_;
+       it = pending_.erase(it)) {
+    std::fwrite(it->second.data(), 1, it->second.size(), out_);
+    ++next_;
+  }
+
+  std::fflush(out_);
+}
+
+size_t ordered_writer::written() const
+{
+  auto lock = std::lock_guard {mutex_};
+  return next_;
+}
+
+} // namespace support
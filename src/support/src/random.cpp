@@ -1,13 +1,240 @@
 #include <support/random.h>
 
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
 namespace support {
 
+namespace {
+
+struct master_state {
+  master_state()
+      : mutex {}
+      , seed(get_random_device()())
+      , generation(0)
+      , next_stream(0)
+  {
+  }
+
+  std::mutex mutex;
+  uint64_t seed;
+
+  // Bumped whenever the seed changes so that threads know to re-derive their
+  // streams; it's checked on every draw, so the fast path can't take the lock.
+  std::atomic<uint64_t> generation;
+  uint64_t next_stream;
+};
+
+master_state& master()
+{
+  static auto state = master_state {};
+  return state;
+}
+
+struct thread_stream {
+  bool has_generation = false;
+  uint64_t generation = 0;
+
+  bool is_explicit = false;
+  uint64_t index = 0;
+
+  xoshiro256ss engine {};
+};
+
+thread_local auto stream = thread_stream {};
+
+// The high 64 bits of the 128-bit product a * b, built from 32-bit halves so
+// that it doesn't need a (non-standard) 128-bit integer type.
+uint64_t mul_high(uint64_t a, uint64_t b)
+{
+  auto a_lo = a & 0xFFFFFFFF;
+  auto a_hi = a >> 32;
+  auto b_lo = b & 0xFFFFFFFF;
+  auto b_hi = b >> 32;
+
+  auto lo_lo = a_lo * b_lo;
+  auto hi_lo = a_hi * b_lo;
+  auto lo_hi = a_lo * b_hi;
+  auto hi_hi = a_hi * b_hi;
+
+  auto mid = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  return hi_hi + (hi_lo >> 32) + (mid >> 32);
+}
+
+} // namespace
+
 std::random_device& get_random_device()
 {
   static std::random_device rd{};
   return rd;
 }
 
-std::mt19937 get_random_engine() { return std::mt19937(get_random_device()()); }
+void set_random_seed(uint64_t seed)
+{
+  auto& m = master();
+  auto lock = std::lock_guard {m.mutex};
+
+  m.seed = seed;
+  m.next_stream = 0;
+  m.generation.fetch_add(1);
+}
+
+uint64_t get_random_seed()
+{
+  auto& m = master();
+  auto lock = std::lock_guard {m.mutex};
+  return m.seed;
+}
+
+void use_random_stream(uint64_t k)
+{
+  stream.is_explicit = true;
+  stream.index = k;
+  stream.has_generation = false;
+}
+
+xoshiro256ss& thread_random_engine()
+{
+  auto& m = master();
+
+  if (stream.has_generation && stream.generation == m.generation.load()) {
+    return stream.engine;
+  }
+
+  auto lock = std::lock_guard {m.mutex};
+
+  if (!stream.is_explicit) {
+    stream.index = m.next_stream++;
+  }
+
+  // Implicit streams are long jumps apart and explicit ones (offset by one so
+  // that the first doesn't coincide with implicit stream 0) are short jumps
+  // apart, so none of them can overlap.
+  stream.engine = xoshiro256ss(m.seed);
+  if (stream.is_explicit) {
+    for (auto i = uint64_t {0}; i <= stream.index; ++i) {
+      stream.engine.jump();
+    }
+  } else {
+    for (auto i = uint64_t {0}; i < stream.index; ++i) {
+      stream.engine.long_jump();
+    }
+  }
+
+  stream.generation = m.generation.load();
+  stream.has_generation = true;
+
+  return stream.engine;
+}
+
+uint64_t random_seed() { return thread_random_engine()(); }
+
+xoshiro256ss::xoshiro256ss(uint64_t seed)
+    : state_ {}
+{
+  this->seed(seed);
+}
+
+void xoshiro256ss::seed(uint64_t seed)
+{
+  // The state must not be all zero; expanding the seed with splitmix64 (as
+  // recommended by the xoshiro authors) guarantees this.
+  for (auto& word : state_) {
+    seed += 0x9e3779b97f4a7c15;
+
+    auto z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    word = z ^ (z >> 31);
+  }
+}
+
+void xoshiro256ss::jump()
+{
+  jump_with(
+      {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+       0x39abdc4529b1661c});
+}
+
+void xoshiro256ss::long_jump()
+{
+  jump_with(
+      {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241,
+       0x39109bb02acbe635});
+}
+
+xoshiro256ss xoshiro256ss::split()
+{
+  auto child = *this;
+  jump();
+  return child;
+}
+
+void xoshiro256ss::jump_with(std::array<uint64_t, 4> const& poly)
+{
+  auto acc = std::array<uint64_t, 4> {};
+
+  for (auto word : poly) {
+    for (auto b = 0; b < 64; ++b) {
+      if (word & (uint64_t {1} << b)) {
+        for (auto i = 0u; i < acc.size(); ++i) {
+          acc[i] ^= state_[i];
+        }
+      }
+
+      (*this)();
+    }
+  }
+
+  state_ = acc;
+}
+
+void fill_uniform(
+    xoshiro256ss& engine, int64_t* out, size_t n, int64_t lo, int64_t hi)
+{
+  // Computed in unsigned arithmetic so that the full int64_t range doesn't
+  // overflow; a range of zero then means every value is possible.
+  auto range = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1;
+
+  for (auto i = 0u; i < n; ++i) {
+    auto x = engine();
+
+    if (range != 0) {
+      x = mul_high(x, range);
+    }
+
+    out[i] = static_cast<int64_t>(static_cast<uint64_t>(lo) + x);
+  }
+}
+
+void fill_uniform(
+    xoshiro256ss& engine, float* out, size_t n, float lo, float hi)
+{
+  auto scale = hi - lo;
+
+  for (auto i = 0u; i < n; ++i) {
+    // The top 24 bits give every float in [0, 1) with a representable
+    // multiple of 2^-24.
+    auto unit = static_cast<float>(engine() >> 40) * 0x1.0p-24f;
+    out[i] = std::min(lo + scale * unit, std::nextafter(hi, lo));
+  }
+}
+
+void fill_uniform(xoshiro256ss& engine, char* out, size_t n)
+{
+  auto i = size_t {0};
+
+  for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+    auto x = engine();
+    std::memcpy(out + i, &x, sizeof(x));
+  }
+
+  if (i < n) {
+    auto x = engine();
+    std::memcpy(out + i, &x, n - i);
+  }
+}
 
 } // namespace support
@@ -0,0 +1,202 @@
+#include <support/sandbox.h>
+
+#include <fmt/format.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace support {
+
+namespace {
+
+// Workers can be forked from any thread, so they inherit every descriptor open
+// in the parent at the time - including the ends of other workers' sockets.
+// Holding those open would stop the other workers (and their parents) from
+// seeing EOF when the peer goes away, so everything other than the standard
+// streams and the worker's own socket is closed.
+void close_inherited_fds(int keep)
+{
+  auto first = STDERR_FILENO + 1;
+
+#if defined(__linux__) && defined(SYS_close_range)
+  if (keep > first) {
+    syscall(SYS_close_range, first, keep - 1, 0);
+  }
+
+  if (syscall(SYS_close_range, keep + 1, ~0U, 0) == 0) {
+    return;
+  }
+#endif
+
+  auto max_fd = static_cast<int>(sysconf(_SC_OPEN_MAX));
+  for (auto fd = first; fd < max_fd; ++fd) {
+    if (fd != keep) {
+      close(fd);
+    }
+  }
+}
+
+[[noreturn]] void serve(call_wrapper::raw_function entry, uint8_t* args, int fd)
+{
+  // Crashes need to kill the worker rather than being caught by any handlers
+  // installed by the parent (e.g. a test framework's).
+  for (auto sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+    signal(sig, SIG_DFL);
+  }
+
+#ifdef __linux__
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+
+  while (true) {
+    auto cmd = uint8_t {0};
+    if (read(fd, &cmd, sizeof(cmd)) != sizeof(cmd)) {
+      _exit(0);
+    }
+
+    auto ret = entry(args);
+    if (write(fd, &ret, sizeof(ret)) != sizeof(ret)) {
+      _exit(1);
+    }
+  }
+}
+
+sandbox_error system_error(std::string const& what)
+{
+  return sandbox_error(fmt::format("{}: {}", what, std::strerror(errno)));
+}
+
+} // namespace
+
+sandbox::sandbox(
+    call_wrapper& wrap, std::chrono::milliseconds timeout, size_t shared_size)
+    : entry_(wrap.raw_entry())
+    , timeout_(timeout)
+    , shared_(nullptr)
+    , shared_size_(shared_size)
+    , worker_(-1)
+    , socket_(-1)
+    , restarts_(0)
+{
+  auto mem = mmap(
+      nullptr, shared_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+  if (mem == MAP_FAILED) {
+    throw system_error("Couldn't map sandbox memory");
+  }
+
+  shared_ = static_cast<uint8_t*>(mem);
+}
+
+sandbox::~sandbox()
+{
+  // The worker holds no state worth shutting down cleanly, and waiting for it
+  // to notice that the socket has closed could block.
+  if (worker_ > 0) {
+    stop();
+  }
+
+  munmap(shared_, shared_size_);
+}
+
+void sandbox::start()
+{
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+    throw system_error("Couldn't create sandbox socket");
+  }
+
+  auto pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    throw system_error("Couldn't fork sandbox worker");
+  }
+
+  if (pid == 0) {
+    close_inherited_fds(fds[1]);
+    serve(entry_, shared_, fds[1]);
+  }
+
+  close(fds[1]);
+  worker_ = pid;
+  socket_ = fds[0];
+}
+
+int sandbox::stop()
+{
+  kill(worker_, SIGKILL);
+  close(socket_);
+
+  auto status = 0;
+  waitpid(worker_, &status, 0);
+
+  worker_ = -1;
+  socket_ = -1;
+
+  return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+sandbox_result sandbox::call(call_builder& build)
+{
+  if (build.packed_size() > shared_size_) {
+    throw sandbox_error(fmt::format(
+        "Argument pack ({} bytes) is too large for the sandbox ({} bytes)",
+        build.packed_size(), shared_size_));
+  }
+
+  if (worker_ < 0) {
+    start();
+  }
+
+  build.pack_into(shared_);
+
+  auto cmd = uint8_t {1};
+  auto sent = send(socket_, &cmd, sizeof(cmd), MSG_NOSIGNAL);
+
+  auto ret = uint64_t {0};
+  auto received = ssize_t {0};
+
+  if (sent == sizeof(cmd)) {
+    auto pfd = pollfd {socket_, POLLIN, 0};
+
+    auto ready = 0;
+    do {
+      ready = poll(&pfd, 1, static_cast<int>(timeout_.count()));
+    } while (ready < 0 && errno == EINTR);
+
+    if (ready == 0) {
+      stop();
+      ++restarts_;
+      return {sandbox_status::timed_out, 0, 0};
+    }
+
+    received = recv(socket_, &ret, sizeof(ret), MSG_WAITALL);
+  }
+
+  if (received != sizeof(ret)) {
+    auto sig = stop();
+    ++restarts_;
+    return {sandbox_status::crashed, 0, sig};
+  }
+
+  build.unpack_from(shared_);
+  return {sandbox_status::ok, ret, 0};
+}
+
+size_t sandbox::restarts() const { return restarts_; }
+
+} // namespace support
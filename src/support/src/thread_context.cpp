@@ -10,17 +10,27 @@ thread_context& thread_context::instance()
   return instance;
 }
 
-LLVMContext& thread_context::get(std::thread::id id)
+orc::ThreadSafeContext thread_context::safe(std::thread::id id)
 {
   std::lock_guard l{ instance().map_mutex_ };
 
   auto& m = instance().mapping_;
 
   if (m.find(id) == std::end(m)) {
-    m[id] = std::make_unique<LLVMContext>();
+    m[id] = orc::ThreadSafeContext(std::make_unique<LLVMContext>());
   }
 
-  return *m[id];
+  return m[id];
+}
+
+orc::ThreadSafeContext thread_context::safe()
+{
+  return safe(std::this_thread::get_id());
+}
+
+LLVMContext& thread_context::get(std::thread::id id)
+{
+  return *safe(id).getContext();
 }
 
 LLVMContext& thread_context::get() { return get(std::this_thread::get_id()); }
@@ -0,0 +1,98 @@
+#include <support/watchdog.h>
+
+namespace support {
+
+watchdog::watchdog()
+    : next_(0)
+    , running_(std::nullopt)
+    , stop_(false)
+    , thread_([this] { run(); })
+{
+}
+
+watchdog::~watchdog()
+{
+  {
+    auto l = std::lock_guard {mutex_};
+    stop_ = true;
+  }
+
+  wake_.notify_all();
+  thread_.join();
+}
+
+watchdog& watchdog::get()
+{
+  static auto instance = watchdog();
+  return instance;
+}
+
+watchdog::handle
+watchdog::schedule(clock::time_point deadline, std::function<void()> action)
+{
+  auto l = std::lock_guard {mutex_};
+
+  auto h = next_++;
+  auto is_first = pending_.empty() || deadline < pending_.begin()->first.first;
+
+  pending_.emplace(std::pair {deadline, h}, std::move(action));
+  deadlines_.emplace(h, deadline);
+
+  // The watchdog thread only needs waking if it's now sleeping for too long.
+  if (is_first) {
+    wake_.notify_all();
+  }
+
+  return h;
+}
+
+bool watchdog::cancel(handle h)
+{
+  auto l = std::unique_lock {mutex_};
+
+  auto found = deadlines_.find(h);
+  if (found != deadlines_.end()) {
+    pending_.erase({found->second, h});
+    deadlines_.erase(found);
+    return true;
+  }
+
+  finished_.wait(l, [&] { return running_ != h; });
+  return false;
+}
+
+void watchdog::run()
+{
+  auto l = std::unique_lock {mutex_};
+
+  while (!stop_) {
+    if (pending_.empty()) {
+      wake_.wait(l);
+      continue;
+    }
+
+    auto next = pending_.begin();
+    auto deadline = next->first.first;
+
+    if (clock::now() < deadline) {
+      wake_.wait_until(l, deadline);
+      continue;
+    }
+
+    auto h = next->first.second;
+    auto action = std::move(next->second);
+
+    pending_.erase(next);
+    deadlines_.erase(h);
+    running_ = h;
+
+    l.unlock();
+    action();
+    l.lock();
+
+    running_ = std::nullopt;
+    finished_.notify_all();
+  }
+}
+
+} // namespace support
@@ -0,0 +1,17 @@
+#include <support/work_queue.h>
+
+#include <algorithm>
+
+namespace support {
+
+work_queue::work_queue(unsigned threads)
+    : threads_(threads)
+{
+  if (threads_ == 0) {
+    threads_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+unsigned work_queue::threads() const { return threads_; }
+
+} // namespace support
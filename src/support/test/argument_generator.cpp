@@ -4,6 +4,7 @@
 
 #include <props/props.h>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace props;
@@ -26,6 +27,102 @@ TEST_CASE("uniform generator works")
   }
 }
 
+TEST_CASE("uniform generator respects bounds")
+{
+  auto sig = "void f(int n, int *xs, float *ys, char *cs)"_sig;
+
+  auto check = [&](auto& gen) {
+    for (auto i = 0; i < 10; ++i) {
+      auto build = call_builder(sig);
+      gen.gen_args(build);
+
+      REQUIRE(build.ready());
+
+      auto xs = build.view<int64_t>("xs");
+      auto ys = build.view<float>("ys");
+
+      REQUIRE(xs.size() == 4 * 4 * 4);
+      REQUIRE(ys.size() == 4 * 4 * 4);
+      REQUIRE(build.view<char>("cs").size() == 4 * 4 * 4);
+
+      REQUIRE(std::all_of(xs.begin(), xs.end(), [&](auto x) {
+        return x >= gen.int_min && x <= gen.int_max;
+      }));
+
+      REQUIRE(std::all_of(ys.begin(), ys.end(), [&](auto y) {
+        return y >= gen.float_min && y < gen.float_max;
+      }));
+    }
+  };
+
+  SECTION("generating fresh arrays")
+  {
+    auto gen = uniform_generator(4);
+    check(gen);
+  }
+
+  SECTION("drawing arrays from pools")
+  {
+    auto gen = uniform_generator(4);
+    gen.preallocate(8);
+    check(gen);
+
+    gen.int_min = 100;
+    gen.int_max = 200;
+    check(gen);
+  }
+}
+
+TEST_CASE("uniform generator pools give varied arrays")
+{
+  auto sig = "void f(int *xs)"_sig;
+
+  auto gen = uniform_generator(8);
+  gen.preallocate(16);
+  gen.seed(0);
+
+  auto first = call_builder(sig);
+  gen.gen_args(first);
+
+  auto any_different = false;
+  for (auto i = 0; i < 10; ++i) {
+    auto build = call_builder(sig);
+    gen.gen_args(build);
+
+    any_different = any_different || !(build == first);
+  }
+
+  REQUIRE(any_different);
+}
+
+TEST_CASE("uniform generator is deterministic when seeded")
+{
+  auto sig = "void f(int n, float *xs, char *cs)"_sig;
+
+  for (auto reuse : {false, true}) {
+    auto a = uniform_generator(8);
+    auto b = uniform_generator(8);
+
+    if (reuse) {
+      a.preallocate(4);
+      b.preallocate(4);
+    }
+
+    a.seed(12);
+    b.seed(12);
+
+    for (auto i = 0; i < 5; ++i) {
+      auto ba = call_builder(sig);
+      auto bb = call_builder(sig);
+
+      a.gen_args(ba);
+      b.gen_args(bb);
+
+      REQUIRE(ba == bb);
+    }
+  }
+}
+
 TEST_CASE("override generator works")
 {
   SECTION("it is a generator")
@@ -58,6 +155,58 @@ TEST_CASE("override generator works")
   }
 }
 
+TEST_CASE("uniform generator uses size properties")
+{
+  auto ps = R"(
+void f(float *xs, int n, int m, float *ys, int *zs, float *ws, int k)
+size xs, n
+size ys, m
+pack ys, 3
+size zs, n
+)"_ps;
+
+  SECTION("sized arrays match their sizes")
+  {
+    auto gen = uniform_generator(ps, 8);
+
+    for (auto i = 0; i < 20; ++i) {
+      auto build = call_builder(ps.type_signature);
+      gen.gen_args(build);
+
+      REQUIRE(build.ready());
+
+      auto n = build.get<int64_t>("n");
+      auto m = build.get<int64_t>("m");
+
+      REQUIRE(n >= 0);
+      REQUIRE(m >= 0);
+
+      REQUIRE(build.view<float>("xs").size() == size_t(n));
+      REQUIRE(build.view<float>("ys").size() == size_t(3 * m));
+      REQUIRE(build.view<int64_t>("zs").size() == size_t(n));
+      REQUIRE(build.view<float>("ws").size() == 8 * 8 * 8);
+    }
+  }
+
+  SECTION("overridden sizes are respected")
+  {
+    auto gen = override_generator("n", 1000ll, ps, 8);
+
+    auto build = call_builder(ps.type_signature);
+    gen.gen_args(build);
+
+    REQUIRE(build.get<int64_t>("n") == 1000);
+    REQUIRE(build.view<float>("xs").size() == 1000);
+    REQUIRE(build.view<int64_t>("zs").size() == 1000);
+
+    gen.set_value("n", 3);
+    build = call_builder(ps.type_signature);
+    gen.gen_args(build);
+
+    REQUIRE(build.view<float>("xs").size() == 3);
+  }
+}
+
 TEST_CASE("CSR SPMV generator works")
 {
   SECTION("it is a generator")
@@ -401,3 +401,111 @@ TEST_CASE("Can compare call builders for equality")
     REQUIRE(!c7.scalar_args_equal(c8));
   }
 }
+
+TEST_CASE("Pointer arguments are materialised from the arena")
+{
+  auto sig = "void f(int n, char *c, float *f, int *i)"_sig;
+  auto b = call_builder(
+      sig, 3, std::vector<char> {'a', 'b', 'c'}, std::vector<float> {1, 2},
+      std::vector<int64_t> {4, 5, 6, 7});
+
+  auto load_ptr = [](uint8_t* args, size_t offset) {
+    return detail::from_bytes<void*>(args + offset);
+  };
+
+  SECTION("Pointers refer to the builder's own data")
+  {
+    auto args = b.args();
+
+    auto chars = static_cast<char*>(load_ptr(args, 8));
+    auto floats = static_cast<float*>(load_ptr(args, 16));
+    auto ints = static_cast<int64_t*>(load_ptr(args, 24));
+
+    REQUIRE(chars[2] == 'c');
+    REQUIRE(floats[1] == 2.0f);
+    REQUIRE(ints[3] == 7);
+
+    REQUIRE(reinterpret_cast<uintptr_t>(floats) % 16 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(ints) % 16 == 0);
+
+    ints[0] = 40;
+    REQUIRE(b.get<std::vector<int64_t>>(3) == std::vector<int64_t> {40, 5, 6, 7});
+  }
+
+  SECTION("Copies don't alias the original")
+  {
+    auto copy = b;
+    REQUIRE(copy == b);
+
+    auto ints = static_cast<int64_t*>(load_ptr(copy.args(), 24));
+    REQUIRE(ints != load_ptr(b.args(), 24));
+
+    ints[1] = 50;
+    REQUIRE(copy != b);
+    REQUIRE(b.get<std::vector<int64_t>>(3) == std::vector<int64_t> {4, 5, 6, 7});
+    REQUIRE(copy.get<std::vector<char>>(1) == std::vector<char> {'a', 'b', 'c'});
+  }
+
+  SECTION("Assignment and reset reuse the pack")
+  {
+    auto scratch = call_builder(sig);
+    scratch = b;
+    REQUIRE(scratch == b);
+
+    scratch.reset();
+    REQUIRE(scratch.args_count() == 0);
+
+    scratch.add(
+        1, std::vector<char> {'z'}, std::vector<float> {},
+        std::vector<int64_t> {9});
+    REQUIRE(scratch.ready());
+    REQUIRE(scratch.get<std::vector<char>>(1) == std::vector<char> {'z'});
+    REQUIRE(scratch.get<std::vector<float>>(2).empty());
+    REQUIRE(scratch.get<std::vector<int64_t>>(3) == std::vector<int64_t> {9});
+  }
+}
+
+TEST_CASE("Can view pointer arguments without copying")
+{
+  auto b = call_builder(
+      "void f(int n, int *xs, float *ys)"_sig, 2, std::vector<int64_t> {3, 4},
+      std::vector<float> {1.5, 2.5, 3.5});
+
+  SECTION("Views refer to stored data")
+  {
+    auto xs = b.view<int64_t>(1);
+    REQUIRE(xs.size() == 2);
+    REQUIRE(xs[1] == 4);
+
+    auto ys = b.view<float>("ys");
+    REQUIRE(ys.vec() == std::vector<float> {1.5, 2.5, 3.5});
+
+    auto raw = b.args();
+    REQUIRE(detail::from_bytes<void*>(raw + 16) == ys.data());
+  }
+
+  SECTION("Invalid views are rejected")
+  {
+    REQUIRE_THROWS_AS(b.view<int64_t>(0), call_builder_error);
+    REQUIRE_THROWS_AS(b.view<float>(1), call_builder_error);
+    REQUIRE_THROWS_AS(b.view<int64_t>(3), call_builder_error);
+
+    auto partial = call_builder("void f(int *xs, float *ys)"_sig);
+    partial.add(std::vector<int64_t> {1});
+    REQUIRE_THROWS_AS(partial.view<float>(1), call_builder_error);
+  }
+
+  SECTION("Visitors receive views")
+  {
+    auto sizes = std::vector<size_t> {};
+    b.visit_pointer_args([&](auto vv) {
+      static_assert(
+          std::is_same_v<
+              decltype(vv), llvm::ArrayRef<typename decltype(vv)::value_type>>,
+          "Visited pointers should be views");
+      sizes.push_back(vv.size());
+    });
+
+    REQUIRE(sizes == std::vector<size_t> {2, 3});
+  }
+}
@@ -0,0 +1,157 @@
+#include <support/example_file.h>
+#include <support/example_set.h>
+#include <support/thread_context.h>
+
+#include <props/props.h>
+
+#include <llvm/IR/Module.h>
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace support;
+using namespace props::literals;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void scale(int64_t n, float* xs)
+{
+  for (auto i = 0; i < n; ++i) {
+    xs[i] *= 2;
+  }
+}
+
+void scale_wrong(int64_t n, float* xs)
+{
+  for (auto i = 0; i < n; ++i) {
+    xs[i] *= 3;
+  }
+}
+
+std::string temp_path(std::string const& name)
+{
+  return (fs::temp_directory_path() / name).string();
+}
+
+} // namespace
+
+TEST_CASE("Recorded examples can be read back")
+{
+  auto sig = "int f(int n, float *xs, char c, int *ys)"_sig;
+  auto path = temp_path("example_file_roundtrip.bin");
+
+  auto inputs = std::vector<call_builder> {};
+  auto outputs = std::vector<call_builder> {};
+
+  for (auto i = 0; i < 10; ++i) {
+    auto xs = std::vector<float>(i, 0.5f * i);
+    auto ys = std::vector<int64_t>(2 * i + 1, -i);
+
+    inputs.emplace_back(sig, int64_t {i}, xs, static_cast<char>('a' + i), ys);
+
+    for (auto& y : ys) {
+      y += 100;
+    }
+    outputs.emplace_back(sig, int64_t {i}, xs, static_cast<char>('a' + i), ys);
+  }
+
+  {
+    auto writer = example_writer(path, sig);
+    for (auto i = 0u; i < inputs.size(); ++i) {
+      writer.write(inputs[i], outputs[i], i * 3);
+    }
+
+    REQUIRE(writer.written() == inputs.size());
+  }
+
+  auto reader = example_reader(path);
+  REQUIRE(reader.signature() == sig);
+  REQUIRE(reader.size() == inputs.size());
+
+  for (auto i = 0u; i < inputs.size(); ++i) {
+    REQUIRE(reader.input(i) == inputs[i]);
+
+    auto out = reader.output(i);
+    REQUIRE(out.return_value == i * 3);
+    REQUIRE(out.output_args == outputs[i]);
+  }
+
+  fs::remove(path);
+}
+
+TEST_CASE("Malformed example files are rejected")
+{
+  auto sig = "void f(int n, float *xs)"_sig;
+  auto path = temp_path("example_file_malformed.bin");
+
+  SECTION("Missing files")
+  {
+    fs::remove(path);
+    REQUIRE_THROWS_AS(example_reader(path), example_file_error);
+  }
+
+  SECTION("Truncated records")
+  {
+    {
+      auto writer = example_writer(path, sig);
+      auto build = call_builder(sig, int64_t {4}, std::vector<float>(4, 1.0f));
+      writer.write(build, build, 0);
+      writer.write(build, build, 0);
+    }
+
+    fs::resize_file(path, fs::file_size(path) - 4);
+    REQUIRE_THROWS_AS(example_reader(path), example_file_error);
+  }
+
+  SECTION("Other files")
+  {
+    {
+      auto writer = example_writer(path, sig);
+    }
+
+    auto size = fs::file_size(path);
+    fs::remove(path);
+    fs::copy_file(fs::path(__FILE__), path);
+    fs::resize_file(path, size);
+
+    REQUIRE_THROWS_AS(example_reader(path), example_file_error);
+  }
+
+  fs::remove(path);
+}
+
+TEST_CASE("Example sets can be loaded from recorded files")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "void f(int n, float *xs)"_sig;
+  auto path = temp_path("example_file_set.bin");
+
+  auto ref = call_wrapper(sig, mod, "scale", scale);
+  auto bad = call_wrapper(sig, mod, "scale_wrong", scale_wrong);
+
+  {
+    auto writer = example_writer(path, sig);
+
+    for (auto i = 1; i < 8; ++i) {
+      auto input = call_builder(sig, int64_t {i}, std::vector<float>(i, 1.5f));
+      auto output = input;
+      auto rv = ref.call(output);
+
+      writer.write(input, output, rv);
+    }
+  }
+
+  auto examples = example_set(sig);
+  examples.load(example_reader(path));
+
+  REQUIRE(examples.size() == 7);
+  REQUIRE(examples.check(ref));
+  REQUIRE(!examples.check(bad));
+
+  fs::remove(path);
+}
@@ -0,0 +1,142 @@
+#include <support/example_set.h>
+#include <support/thread_context.h>
+
+#include <props/props.h>
+
+#include <llvm/IR/Module.h>
+
+#include <catch2/catch.hpp>
+
+using namespace support;
+using namespace props::literals;
+
+namespace {
+
+int64_t add_one(int64_t x) { return x + 1; }
+int64_t add_one_small(int64_t x) { return x < 10 ? x + 1 : 0; }
+int64_t zero(int64_t) { return 0; }
+
+void scale(int64_t n, float* xs)
+{
+  for (auto i = 0; i < n; ++i) {
+    xs[i] *= 2;
+  }
+}
+
+void scale_wrong(int64_t n, float* xs)
+{
+  for (auto i = 0; i < n; ++i) {
+    xs[i] *= 3;
+  }
+}
+
+} // namespace
+
+TEST_CASE("Example sets compute reference outputs once")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int x)"_sig;
+
+  auto ref = call_wrapper(sig, mod, "add_one", add_one);
+  auto good = call_wrapper(sig, mod, "add_one", add_one);
+  auto bad = call_wrapper(sig, mod, "zero", zero);
+
+  auto examples = example_set(sig);
+  for (auto i = 0; i < 16; ++i) {
+    examples.add(ref, call_builder(sig, i));
+  }
+
+  REQUIRE(examples.size() == 16);
+  REQUIRE(examples.examples()[3].output.return_value == 4);
+
+  REQUIRE(examples.check(good));
+  REQUIRE(!examples.check(bad));
+}
+
+TEST_CASE("Failing examples are replayed first")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int x)"_sig;
+
+  auto ref = call_wrapper(sig, mod, "add_one", add_one);
+  auto small = call_wrapper(sig, mod, "add_one_small", add_one_small);
+
+  auto examples = example_set(sig);
+  examples.add(ref, call_builder(sig, 1));
+  examples.add(ref, call_builder(sig, 2));
+  examples.add(ref, call_builder(sig, 20));
+
+  REQUIRE(!examples.check(small));
+
+  // The large example has been moved to the front, so a candidate that is only
+  // wrong on it should be rejected with a single call.
+  auto calls = 0;
+  auto counting = [&calls](int64_t x) {
+    ++calls;
+    return x < 10 ? x + 1 : 0;
+  };
+
+  static decltype(counting)* fn = nullptr;
+  fn = &counting;
+
+  auto counted = call_wrapper(
+      sig, mod, "counted", +[](int64_t x) -> int64_t { return (*fn)(x); });
+
+  REQUIRE(!examples.check(counted));
+  REQUIRE(calls == 1);
+}
+
+TEST_CASE("Example sets compare pointer outputs")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "void f(int n, float *xs)"_sig;
+
+  auto ref = call_wrapper(sig, mod, "scale", scale);
+  auto good = call_wrapper(sig, mod, "scale", scale);
+  auto bad = call_wrapper(sig, mod, "scale_wrong", scale_wrong);
+
+  auto examples = example_set(sig);
+  examples.add(ref, call_builder(sig, 3, std::vector<float> {1, 2, 3}));
+
+  auto const& ex = examples.examples().front();
+  REQUIRE(ex.input.get<std::vector<float>>(1) == std::vector<float> {1, 2, 3});
+  REQUIRE(
+      ex.output.output_args.get<std::vector<float>>(1)
+      == std::vector<float> {2, 4, 6});
+
+  REQUIRE(examples.check(good));
+  REQUIRE(!examples.check(bad));
+
+  // Checking must not modify the stored inputs
+  REQUIRE(ex.input.get<std::vector<float>>(1) == std::vector<float> {1, 2, 3});
+}
+
+TEST_CASE("Example sets measure total error over every example")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int x)"_sig;
+
+  auto ref = call_wrapper(sig, mod, "add_one", add_one);
+  auto near = call_wrapper(sig, mod, "add_one_small", add_one_small);
+  auto far = call_wrapper(sig, mod, "zero", zero);
+
+  auto examples = example_set(sig);
+  for (auto i = 0; i < 12; ++i) {
+    examples.add(ref, call_builder(sig, i));
+  }
+
+  auto distance = [](output_example const& exp, output_example const& act) {
+    return static_cast<int>(std::abs(
+        static_cast<int64_t>(exp.return_value)
+        - static_cast<int64_t>(act.return_value)));
+  };
+
+  REQUIRE(examples.error(ref, distance) == 0);
+
+  // add_one_small is only wrong for 10 and 11.
+  REQUIRE(examples.error(near, distance) == 11 + 12);
+  REQUIRE(examples.error(far, distance) == 78);
+
+  // Measuring error doesn't stop early, or change the replay order.
+  REQUIRE(examples.check(ref));
+}
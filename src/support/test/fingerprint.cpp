@@ -0,0 +1,258 @@
+#include <support/fingerprint.h>
+#include <support/thread_context.h>
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace support;
+using namespace llvm;
+
+namespace {
+
+struct options {
+  std::string name = "f";
+  int64_t constant = 3;
+  bool dead_code = false;
+  bool unreachable = false;
+  bool named_values = false;
+};
+
+// Build: i64 f(i64 x, i64 y) { return (x + c) * y; }, with variations that
+// shouldn't change the function's behaviour.
+Function* build_function(Module& mod, options const& opts)
+{
+  auto& ctx = mod.getContext();
+  auto i64 = IntegerType::get(ctx, 64);
+
+  auto fn = Function::Create(
+      FunctionType::get(i64, {i64, i64}, false), GlobalValue::ExternalLinkage,
+      opts.name, mod);
+
+  auto entry = BasicBlock::Create(ctx, "entry", fn);
+  auto build = IRBuilder(entry);
+
+  auto x = fn->getArg(0);
+  auto y = fn->getArg(1);
+
+  auto sum = build.CreateAdd(
+      x, ConstantInt::get(i64, opts.constant),
+      opts.named_values ? "sum" : "");
+
+  if (opts.dead_code) {
+    auto dead = build.CreateMul(sum, sum);
+    build.CreateSub(dead, x);
+  }
+
+  auto prod = build.CreateMul(sum, y, opts.named_values ? "prod" : "");
+  build.CreateRet(prod);
+
+  if (opts.unreachable) {
+    auto other = BasicBlock::Create(ctx, "other", fn);
+    auto other_build = IRBuilder(other);
+    other_build.CreateRet(other_build.CreateAdd(x, y));
+  }
+
+  return fn;
+}
+
+uint64_t fingerprint_of(options const& opts)
+{
+  auto mod = Module("test", thread_context::get());
+  return fingerprint(*build_function(mod, opts));
+}
+
+// Fingerprint a function whose body is built by the callback, returning the
+// value it produces.
+template <typename Body>
+uint64_t fingerprint_body(Type* ret, std::vector<Type*> params, Body&& body)
+{
+  auto& ctx = thread_context::get();
+  auto mod = Module("test", ctx);
+
+  auto fn = Function::Create(
+      FunctionType::get(ret, params, false), GlobalValue::ExternalLinkage, "f",
+      mod);
+
+  auto build = IRBuilder(BasicBlock::Create(ctx, "entry", fn));
+  auto val = body(build, fn);
+
+  if (ret->isVoidTy()) {
+    build.CreateRetVoid();
+  } else {
+    build.CreateRet(val);
+  }
+
+  return fingerprint(*fn);
+}
+
+} // namespace
+
+TEST_CASE("Fingerprints ignore names")
+{
+  auto base = fingerprint_of({});
+
+  auto renamed = options {};
+  renamed.name = "g";
+  renamed.named_values = true;
+
+  REQUIRE(fingerprint_of(renamed) == base);
+}
+
+TEST_CASE("Fingerprints ignore dead and unreachable code")
+{
+  auto base = fingerprint_of({});
+
+  auto dead = options {};
+  dead.dead_code = true;
+  REQUIRE(fingerprint_of(dead) == base);
+
+  auto unreachable = options {};
+  unreachable.unreachable = true;
+  REQUIRE(fingerprint_of(unreachable) == base);
+}
+
+TEST_CASE("Fingerprints distinguish different functions")
+{
+  auto base = fingerprint_of({});
+
+  auto other_constant = options {};
+  other_constant.constant = 4;
+  REQUIRE(fingerprint_of(other_constant) != base);
+
+  auto mod = Module("test", thread_context::get());
+  auto fn = build_function(mod, {});
+  auto& ret = fn->getEntryBlock().back();
+
+  // Swapping the operands of the multiply changes the structure.
+  auto mul = cast<Instruction>(ret.getOperand(0));
+  auto lhs = mul->getOperand(0);
+  mul->setOperand(0, mul->getOperand(1));
+  mul->setOperand(1, lhs);
+
+  REQUIRE(fingerprint(*fn) != base);
+}
+
+TEST_CASE("Fingerprints are comparable across contexts")
+{
+  auto ctx = LLVMContext();
+  auto mod = Module("other", ctx);
+
+  REQUIRE(fingerprint(*build_function(mod, {})) == fingerprint_of({}));
+}
+
+TEST_CASE("Fingerprint caches reject duplicates")
+{
+  auto cache = fingerprint_cache();
+
+  auto mod = Module("test", thread_context::get());
+  auto f = build_function(mod, {});
+  auto g = build_function(mod, {});
+
+  REQUIRE(g->getName() != f->getName());
+
+  REQUIRE(cache.insert(*f));
+  REQUIRE(!cache.insert(*g));
+  REQUIRE(cache.insert(uint64_t {12}));
+
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.hits() == 1);
+}
+
+TEST_CASE("Fingerprints distinguish instruction immediates")
+{
+  auto& ctx = thread_context::get();
+
+  auto i32 = IntegerType::get(ctx, 32);
+  auto i64 = IntegerType::get(ctx, 64);
+  auto ptr = PointerType::getUnqual(i64);
+  auto pair = StructType::get(ctx, {i64, i64});
+  auto vec = FixedVectorType::get(i32, 4);
+  auto void_ty = Type::getVoidTy(ctx);
+
+  SECTION("Aggregate indices")
+  {
+    auto extract = [&](unsigned idx) {
+      return fingerprint_body(i64, {pair}, [&](auto& build, auto fn) {
+        return build.CreateExtractValue(fn->getArg(0), {idx});
+      });
+    };
+
+    auto insert = [&](unsigned idx) {
+      return fingerprint_body(pair, {pair, i64}, [&](auto& build, auto fn) {
+        return build.CreateInsertValue(fn->getArg(0), fn->getArg(1), {idx});
+      });
+    };
+
+    REQUIRE(extract(0) != extract(1));
+    REQUIRE(insert(0) != insert(1));
+  }
+
+  SECTION("Shuffle masks")
+  {
+    auto shuffle = [&](std::vector<int> mask) {
+      return fingerprint_body(vec, {vec, vec}, [&](auto& build, auto fn) {
+        return build.CreateShuffleVector(fn->getArg(0), fn->getArg(1), mask);
+      });
+    };
+
+    REQUIRE(shuffle({0, 1, 2, 3}) != shuffle({3, 2, 1, 0}));
+  }
+
+  SECTION("Atomic operations")
+  {
+    auto rmw = [&](AtomicRMWInst::BinOp op) {
+      return fingerprint_body(i64, {ptr, i64}, [&](auto& build, auto fn) {
+        return build.Insert(new AtomicRMWInst(
+            op, fn->getArg(0), fn->getArg(1), Align(8),
+            AtomicOrdering::SequentiallyConsistent, SyncScope::System));
+      });
+    };
+
+    REQUIRE(rmw(AtomicRMWInst::Add) != rmw(AtomicRMWInst::Sub));
+  }
+
+  SECTION("Volatility and ordering of memory accesses")
+  {
+    auto load = [&](bool is_volatile, AtomicOrdering order) {
+      return fingerprint_body(i64, {ptr}, [&](auto& build, auto fn) {
+        auto inst
+            = build.CreateAlignedLoad(i64, fn->getArg(0), Align(8), is_volatile);
+        inst->setAtomic(order);
+        return inst;
+      });
+    };
+
+    auto base = load(false, AtomicOrdering::NotAtomic);
+    REQUIRE(load(true, AtomicOrdering::NotAtomic) != base);
+    REQUIRE(load(false, AtomicOrdering::Monotonic) != base);
+    REQUIRE(
+        load(false, AtomicOrdering::Monotonic)
+        != load(false, AtomicOrdering::SequentiallyConsistent));
+  }
+
+  SECTION("Call attributes")
+  {
+    auto call = [&](bool no_inline) {
+      return fingerprint_body(void_ty, {}, [&](auto& build, auto fn) {
+        auto callee = fn->getParent()->getOrInsertFunction(
+            "g", FunctionType::get(void_ty, false));
+
+        auto inst = build.CreateCall(callee);
+        if (no_inline) {
+          inst->addFnAttr(Attribute::NoInline);
+        }
+
+        return inst;
+      });
+    };
+
+    REQUIRE(call(false) != call(true));
+  }
+}
@@ -4,6 +4,8 @@
 #include <catch2/catch.hpp>
 
 #include <iostream>
+#include <limits>
+#include <numeric>
 
 using namespace support;
 
@@ -22,3 +24,100 @@ TEST_CASE("tinkering")
   auto w = detail::equality_wrapper(2.0f);
   REQUIRE(!w.is_negative());
 }
+
+TEST_CASE("Float arrays can be compared approximately")
+{
+  auto levels = std::vector<simd_level> {simd_level::scalar};
+  if (best_simd_level() >= simd_level::sse2) {
+    levels.push_back(simd_level::sse2);
+  }
+  if (best_simd_level() >= simd_level::avx2) {
+    levels.push_back(simd_level::avx2);
+  }
+
+  auto tol = float_tolerance {};
+
+  SECTION("Equal arrays")
+  {
+    auto a = std::vector<float>(37);
+    std::iota(a.begin(), a.end(), -18.0f);
+    auto b = a;
+    b[3] = std::nextafter(b[3], 100.0f);
+    b[20] += 0.0005f;
+    b[18] = -0.0f;
+
+    for (auto level : levels) {
+      auto res = compare_arrays(a, b, tol, level);
+      REQUIRE(res.equal);
+      REQUIRE(res.mismatch_index == a.size());
+      REQUIRE(res.max_error == Approx(0.0005).margin(1e-6));
+    }
+  }
+
+  SECTION("Mismatches are reported at the first differing element")
+  {
+    for (auto idx : {0u, 5u, 8u, 15u, 16u, 30u}) {
+      auto a = std::vector<float>(31, 1.0f);
+      auto b = a;
+      b[idx] = 2.0f;
+      b.back() = 10.0f;
+
+      for (auto level : levels) {
+        auto res = compare_arrays(a, b, tol, level);
+        REQUIRE(!res.equal);
+        REQUIRE(res.mismatch_index == idx);
+        REQUIRE(res.max_error == Approx(idx == 30 ? 9.0 : 1.0));
+      }
+    }
+  }
+
+  SECTION("Backends agree on awkward values")
+  {
+    auto nan = std::numeric_limits<float>::quiet_NaN();
+    auto inf = std::numeric_limits<float>::infinity();
+    auto vals = std::vector<float> {
+        0.0f, -0.0f, 1.0f, -1.0f, nan, inf, -inf, 1e-30f, -1e-30f, 3.0e38f};
+
+    for (auto x : vals) {
+      for (auto y : vals) {
+        auto a = std::vector<float>(9, x);
+        auto b = std::vector<float>(9, y);
+
+        auto expected = compare_arrays(a, b, tol, simd_level::scalar);
+        for (auto level : levels) {
+          auto res = compare_arrays(a, b, tol, level);
+          REQUIRE(res.equal == expected.equal);
+          REQUIRE(res.mismatch_index == expected.mismatch_index);
+        }
+      }
+    }
+  }
+
+  SECTION("Arrays of different sizes are not equal")
+  {
+    auto a = std::vector<float> {1, 2, 3};
+    auto b = std::vector<float> {1, 2};
+
+    auto res = compare_arrays(a, b);
+    REQUIRE(!res.equal);
+    REQUIRE(res.mismatch_index == 2);
+    REQUIRE(!approx_equal(a, b));
+  }
+}
+
+TEST_CASE("Integer arrays are compared exactly")
+{
+  auto a = std::vector<int64_t> {1, 2, 3, 4};
+  auto b = a;
+  REQUIRE(compare_arrays(a, b).equal);
+
+  b[2] = 7;
+  auto res = compare_arrays(a, b);
+  REQUIRE(!res.equal);
+  REQUIRE(res.mismatch_index == 2);
+  REQUIRE(res.max_error == 4);
+
+  auto c = std::vector<char> {'a', 'b'};
+  auto d = std::vector<char> {'a', 'c'};
+  REQUIRE(compare_arrays(c, d).mismatch_index == 1);
+}
@@ -0,0 +1,137 @@
+#include <support/call_wrapper.h>
+#include <support/load_module.h>
+
+#include <props/props.h>
+
+#include <catch2/catch.hpp>
+
+using namespace support;
+using namespace props::literals;
+
+namespace {
+
+int64_t add_two(int64_t x) { return x + 2; }
+
+int64_t mixed(char c, int64_t x, float y, int64_t* out)
+{
+  out[0] = c + x;
+  return x + static_cast<int64_t>(y);
+}
+
+auto add_one = R"(
+define i64 @f(i64 %x) {
+  %r = add i64 %x, 1
+  ret i64 %r
+})";
+
+auto times_two = R"(
+define i64 @f(i64 %x) {
+  %r = mul i64 %x, 2
+  ret i64 %r
+})";
+
+} // namespace
+
+TEST_CASE("Wrappers with the same symbol names can coexist")
+{
+  auto m1 = parse_module(add_one);
+  auto m2 = parse_module(times_two);
+  REQUIRE((m1 && m2));
+
+  auto sig = "int f(int x)"_sig;
+
+  auto w1 = call_wrapper(sig, *m1, "f");
+  auto w2 = call_wrapper(sig, *m2, "f");
+  auto w3 = call_wrapper(sig, *m1, "f", add_two);
+
+  auto b = call_builder(sig, 5);
+
+  REQUIRE(w1.call(b) == 6);
+  REQUIRE(w2.call(b) == 10);
+  REQUIRE(w3.call(b) == 7);
+  REQUIRE(w1.call(b) == 6);
+}
+
+TEST_CASE("Wrappers can be created and destroyed repeatedly")
+{
+  PARSE_TEST_MODULE(mod, add_one);
+
+  auto sig = "int f(int x)"_sig;
+
+  for (auto i = 0; i < 64; ++i) {
+    auto wrap = call_wrapper(sig, *mod, "f");
+    auto b = call_builder(sig, i);
+
+    REQUIRE(wrap.call(b) == uint64_t(i + 1));
+    REQUIRE(wrap.name() == "f");
+  }
+}
+
+TEST_CASE("Native entry points are resolved once and cached")
+{
+  auto mod = parse_module(add_one);
+  REQUIRE(mod);
+
+  auto sig = "int f(int x)"_sig;
+  auto wrap = call_wrapper(sig, *mod, "f");
+
+  auto entry = wrap.raw_entry();
+  REQUIRE(entry != nullptr);
+  REQUIRE(wrap.raw_entry() == entry);
+
+  auto b = call_builder(sig, 41);
+  REQUIRE(entry(b.args()) == 42);
+  REQUIRE(wrap.call_raw(b.args()) == 42);
+
+  auto [rv, time] = wrap.call_timed(b);
+  REQUIRE(rv == 42);
+  REQUIRE(time.count() >= 0);
+}
+
+TEST_CASE("Argument packs can be called in batches")
+{
+  SECTION("With a JIT-compiled implementation")
+  {
+    auto mod = parse_module(add_one);
+    REQUIRE(mod);
+
+    auto sig = "int f(int x)"_sig;
+    auto wrap = call_wrapper(sig, *mod, "f");
+
+    auto packs = std::vector<call_builder> {};
+    for (auto i = 0; i < 10; ++i) {
+      packs.emplace_back(sig, i);
+    }
+
+    auto results = wrap.call_batch(packs);
+    REQUIRE(results.size() == 10);
+    for (auto i = 0u; i < results.size(); ++i) {
+      REQUIRE(results[i] == i + 1);
+    }
+
+    REQUIRE(wrap.raw_batch_entry() != nullptr);
+    REQUIRE(wrap.call_batch({}).empty());
+  }
+
+  SECTION("With unaligned arguments of mixed types")
+  {
+    auto sig = "int f(char c, int x, float y, int *out)"_sig;
+    auto mod = llvm::Module("test", thread_context::get());
+    auto wrap = call_wrapper(sig, mod, "mixed", mixed);
+
+    auto packs = std::vector<call_builder> {};
+    for (auto i = 0; i < 4; ++i) {
+      packs.emplace_back(
+          sig, char('a' + i), int64_t(100 * i), float(i) + 0.5f,
+          std::vector<int64_t> {0});
+    }
+
+    auto results = wrap.call_batch(packs);
+
+    for (auto i = 0; i < 4; ++i) {
+      REQUIRE(results[i] == uint64_t(101 * i));
+      REQUIRE(packs[i].get<std::vector<int64_t>>(3)[0] == 'a' + 101 * i);
+      REQUIRE(wrap.call(packs[i]) == results[i]);
+    }
+  }
+}
@@ -2,9 +2,16 @@
 
 #include <support/random.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 using namespace support;
 using namespace std::literals::string_literals;
@@ -25,3 +32,142 @@ TEST_CASE("Sampling from empty works")
   auto t = std::tuple{};
   REQUIRE_NOTHROW(uniform_tuple_sample(t, [](auto) { throw 0; }));
 }
+
+TEST_CASE("xoshiro generator is deterministic")
+{
+  auto a = xoshiro256ss(42);
+  auto b = xoshiro256ss(42);
+  auto c = xoshiro256ss(43);
+
+  auto any_different = false;
+  for (auto i = 0; i < 100; ++i) {
+    auto va = a();
+    REQUIRE(va == b());
+    any_different = any_different || (va != c());
+  }
+
+  REQUIRE(any_different);
+
+  a.seed(42);
+  b.seed(42);
+  REQUIRE(a() == b());
+}
+
+TEST_CASE("xoshiro generators can be split")
+{
+  auto parent = xoshiro256ss(42);
+  auto reference = parent;
+
+  auto child = parent.split();
+  REQUIRE(child() == reference());
+
+  auto any_different = false;
+  for (auto i = 0; i < 100; ++i) {
+    any_different = any_different || (parent() != child());
+  }
+
+  REQUIRE(any_different);
+
+  auto jumped = xoshiro256ss(42);
+  jumped.jump();
+
+  auto long_jumped = xoshiro256ss(42);
+  long_jumped.long_jump();
+
+  REQUIRE(jumped() != long_jumped());
+}
+
+TEST_CASE("Seeding the process-wide generator is reproducible")
+{
+  auto draw = [] {
+    auto vals = std::vector<int> {};
+    for (auto i = 0; i < 32; ++i) {
+      vals.push_back(random_int(0, 1000));
+    }
+    return vals;
+  };
+
+  set_random_seed(1234);
+  REQUIRE(get_random_seed() == 1234);
+  auto first = draw();
+
+  set_random_seed(1234);
+  REQUIRE(draw() == first);
+
+  set_random_seed(4321);
+  REQUIRE(draw() != first);
+
+  SECTION("Explicit streams are reproducible and independent")
+  {
+    auto on_stream = [&](uint64_t k) {
+      auto vals = std::vector<int> {};
+      auto t = std::thread([&] {
+        use_random_stream(k);
+        vals = draw();
+      });
+      t.join();
+      return vals;
+    };
+
+    set_random_seed(99);
+    auto s0 = on_stream(0);
+    auto s1 = on_stream(1);
+
+    REQUIRE(s0 != s1);
+    REQUIRE(on_stream(0) == s0);
+    REQUIRE(on_stream(1) == s1);
+
+    set_random_seed(99);
+    REQUIRE(draw() != s0);
+  }
+}
+
+TEST_CASE("Can fill ranges with uniform values")
+{
+  auto engine = xoshiro256ss(7);
+
+  SECTION("Integers")
+  {
+    auto data = std::vector<int64_t>(10'000);
+    fill_uniform(engine, data.data(), data.size(), -4, 3);
+
+    REQUIRE(*std::min_element(data.begin(), data.end()) == -4);
+    REQUIRE(*std::max_element(data.begin(), data.end()) == 3);
+  }
+
+  SECTION("Full integer range")
+  {
+    auto data = std::vector<int64_t>(100);
+    fill_uniform(
+        engine, data.data(), data.size(),
+        std::numeric_limits<int64_t>::min(),
+        std::numeric_limits<int64_t>::max());
+
+    REQUIRE(std::any_of(data.begin(), data.end(), [](auto x) {
+      return x < 0;
+    }));
+  }
+
+  SECTION("Floats")
+  {
+    auto data = std::vector<float>(10'000);
+    fill_uniform(engine, data.data(), data.size(), -5.0f, 5.0f);
+
+    REQUIRE(std::all_of(data.begin(), data.end(), [](auto x) {
+      return x >= -5.0f && x < 5.0f;
+    }));
+
+    auto mean = std::accumulate(data.begin(), data.end(), 0.0) / data.size();
+    REQUIRE(std::abs(mean) < 0.2);
+  }
+
+  SECTION("Characters")
+  {
+    for (auto n : {0, 1, 7, 8, 9, 100}) {
+      auto data = std::vector<char>(n + 1, 'x');
+      fill_uniform(engine, data.data(), n);
+
+      REQUIRE(data.back() == 'x');
+    }
+  }
+}
@@ -0,0 +1,138 @@
+#include <support/sandbox.h>
+#include <support/thread_context.h>
+
+#include <props/props.h>
+
+#include <llvm/IR/Module.h>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <optional>
+
+using namespace support;
+using namespace props::literals;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+int64_t sum(int64_t n, int64_t* xs)
+{
+  auto total = int64_t {0};
+  for (auto i = 0; i < n; ++i) {
+    total += xs[i];
+    xs[i] = total;
+  }
+  return total;
+}
+
+int64_t crash(int64_t n, int64_t*)
+{
+  if (n > 0) {
+    *static_cast<int64_t volatile*>(nullptr) = n;
+  }
+  return 0;
+}
+
+int64_t spin(int64_t n, int64_t*)
+{
+  while (n > 0) {
+    asm volatile("");
+  }
+  return 0;
+}
+
+} // namespace
+
+TEST_CASE("Sandboxed calls behave like direct calls")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int n, int *xs)"_sig;
+
+  auto wrap = call_wrapper(sig, mod, "sum", sum);
+  auto box = sandbox(wrap);
+
+  for (auto i = 0; i < 4; ++i) {
+    auto b = call_builder(sig, 3, std::vector<int64_t> {1, 2, i});
+
+    auto res = box.call(b);
+    REQUIRE(res.ok());
+    REQUIRE(res.return_value == uint64_t(3 + i));
+    REQUIRE(
+        b.get<std::vector<int64_t>>(1) == std::vector<int64_t> {1, 3, 3 + i});
+  }
+
+  REQUIRE(box.restarts() == 0);
+}
+
+TEST_CASE("Crashes are contained by the sandbox")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int n, int *xs)"_sig;
+
+  auto wrap = call_wrapper(sig, mod, "crash", crash);
+  auto box = sandbox(wrap);
+
+  auto bad = call_builder(sig, 1, std::vector<int64_t> {});
+  auto res = box.call(bad);
+  REQUIRE(res.status == sandbox_status::crashed);
+  REQUIRE(res.signal == SIGSEGV);
+  REQUIRE(box.restarts() == 1);
+
+  // A fresh worker is started for the next call
+  auto good = call_builder(sig, 0, std::vector<int64_t> {});
+  REQUIRE(box.call(good).ok());
+}
+
+TEST_CASE("Non-terminating calls are timed out")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int n, int *xs)"_sig;
+
+  auto wrap = call_wrapper(sig, mod, "spin", spin);
+  auto box = sandbox(wrap, 50ms);
+
+  auto bad = call_builder(sig, 1, std::vector<int64_t> {});
+  REQUIRE(box.call(bad).status == sandbox_status::timed_out);
+
+  auto good = call_builder(sig, 0, std::vector<int64_t> {});
+  REQUIRE(box.call(good).ok());
+  REQUIRE(box.restarts() == 1);
+}
+
+TEST_CASE("Sandboxes can be destroyed while other workers are running")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int n, int *xs)"_sig;
+
+  auto wrap = call_wrapper(sig, mod, "sum", sum);
+  auto b = call_builder(sig, 0, std::vector<int64_t> {});
+
+  auto other = std::optional<sandbox> {};
+  auto start = std::chrono::steady_clock::now();
+
+  {
+    auto box = sandbox(wrap);
+    REQUIRE(box.call(b).ok());
+
+    // The second worker is forked while the first one's socket is open.
+    other.emplace(wrap);
+    REQUIRE(other->call(b).ok());
+  }
+
+  REQUIRE(std::chrono::steady_clock::now() - start < 1s);
+  REQUIRE(other->call(b).ok());
+}
+
+TEST_CASE("Oversized argument packs are rejected")
+{
+  auto mod = llvm::Module("test", thread_context::get());
+  auto sig = "int f(int n, int *xs)"_sig;
+
+  auto wrap = call_wrapper(sig, mod, "sum", sum);
+  auto box = sandbox(wrap, 1s, 64);
+
+  auto b = call_builder(sig, 16, std::vector<int64_t>(16, 0));
+  REQUIRE_THROWS_AS(box.call(b), sandbox_error);
+}
@@ -1,12 +1,44 @@
 #include <catch2/catch.hpp>
 
+#include <support/call_wrapper.h>
+#include <support/load_module.h>
 #include <support/timeout.h>
+#include <support/watchdog.h>
 
+#include <props/props.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
 #include <thread>
 
 using namespace support;
+using namespace props::literals;
 using namespace std::literals::chrono_literals;
 
+namespace {
+
+// Sums 0..n-1, so only terminates if n is non-negative (otherwise it would run
+// for an extremely long time).
+auto sum_loop = R"(
+define i64 @f(i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %acc.next = add i64 %acc, %i
+  %next = add i64 %i, 1
+  %done = icmp eq i64 %next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i64 %acc.next
+})";
+
+} // namespace
+
 TEST_CASE("Can run short operations that don't time out")
 {
   auto x = 0;
@@ -41,3 +73,82 @@ TEST_CASE("Can run longer operations")
   timeout(100ms, op, tm_out);
   REQUIRE(x == 0);
 }
+
+TEST_CASE("Timeouts are cancelled when the operation throws")
+{
+  auto fired = std::make_shared<std::atomic<bool>>(false);
+
+  auto op = [] { throw std::runtime_error("failed"); };
+  auto tm_out = [fired] { *fired = true; };
+
+  REQUIRE_THROWS_AS(timeout(50ms, op, tm_out), std::runtime_error);
+
+  std::this_thread::sleep_for(150ms);
+  REQUIRE(!*fired);
+}
+
+TEST_CASE("Watchdog actions can be scheduled and cancelled")
+{
+  auto& dog = watchdog::get();
+
+  SECTION("Actions run after their deadline")
+  {
+    auto ran = std::atomic<int> {0};
+
+    auto h1 = dog.schedule_after(20ms, [&] { ran += 1; });
+    auto h2 = dog.schedule_after(10ms, [&] { ran += 10; });
+
+    std::this_thread::sleep_for(200ms);
+    REQUIRE(ran == 11);
+
+    REQUIRE(!dog.cancel(h1));
+    REQUIRE(!dog.cancel(h2));
+  }
+
+  SECTION("Cancelled actions don't run")
+  {
+    auto ran = std::atomic<bool> {false};
+
+    auto h = dog.schedule_after(50ms, [&] { ran = true; });
+    REQUIRE(dog.cancel(h));
+
+    std::this_thread::sleep_for(100ms);
+    REQUIRE(!ran);
+  }
+}
+
+TEST_CASE("Wrapped functions can be interrupted")
+{
+  auto mod = parse_module(sum_loop);
+  REQUIRE(mod);
+
+  auto sig = "int f(int n)"_sig;
+
+  SECTION("Using call_with_timeout")
+  {
+    auto wrap = call_wrapper(sig, *mod, "f");
+    wrap.enable_interrupts();
+
+    auto good = call_builder(sig, 5);
+    REQUIRE(wrap.call_with_timeout(good, 1s) == 10);
+
+    auto bad = call_builder(sig, -1);
+    REQUIRE(!wrap.call_with_timeout(bad, 50ms));
+
+    // The flag is reset for the next call
+    REQUIRE(wrap.call_with_timeout(good, 1s) == 10);
+  }
+
+  SECTION("Using an external flag")
+  {
+    auto flag = std::atomic<bool> {false};
+
+    auto wrap = call_wrapper(sig, *mod, "f");
+    wrap.enable_interrupts(&flag);
+
+    auto b = call_builder(sig, -1);
+    timeout(50ms, [&] { REQUIRE(wrap.call(b) == 0); }, [&] { flag = true; });
+
+    REQUIRE(flag);
+  }
+}
@@ -0,0 +1,126 @@
+#include <support/ordered_writer.h>
+#include <support/work_queue.h>
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace support;
+
+TEST_CASE("Work queues run every job exactly once")
+{
+  auto queue = work_queue(4);
+  REQUIRE(queue.threads() == 4);
+
+  auto counts = std::vector<std::atomic<int>>(1000);
+  queue.run(counts.size(), [&] { return [&](size_t i) { counts[i]++; }; });
+
+  for (auto const& c : counts) {
+    REQUIRE(c == 1);
+  }
+}
+
+TEST_CASE("Work queues create one worker per thread")
+{
+  auto queue = work_queue(3);
+
+  auto mutex = std::mutex {};
+  auto ids = std::set<std::thread::id> {};
+  auto workers = std::atomic<int> {0};
+
+  queue.run(100, [&] {
+    workers++;
+    return [&](size_t) {
+      auto lock = std::lock_guard {mutex};
+      ids.insert(std::this_thread::get_id());
+    };
+  });
+
+  REQUIRE(workers <= 3);
+  REQUIRE(ids.size() <= 3);
+  REQUIRE(ids.find(std::this_thread::get_id()) == ids.end());
+}
+
+TEST_CASE("Work queues handle fewer jobs than threads")
+{
+  auto queue = work_queue(8);
+
+  auto workers = std::atomic<int> {0};
+  auto sum = std::atomic<size_t> {0};
+
+  queue.run(2, [&] {
+    workers++;
+    return [&](size_t i) { sum += i + 1; };
+  });
+
+  REQUIRE(workers == 2);
+  REQUIRE(sum == 3);
+
+  queue.run(0, [&] {
+    workers++;
+    return [](size_t) {};
+  });
+
+  REQUIRE(workers == 2);
+}
+
+TEST_CASE("Work queues propagate exceptions")
+{
+  auto queue = work_queue(4);
+
+  REQUIRE_THROWS_AS(
+      queue.run(
+          100,
+          [] {
+            return [](size_t i) {
+              if (i == 17) {
+                throw std::runtime_error("bad job");
+              }
+            };
+          }),
+      std::runtime_error);
+}
+
+TEST_CASE("Ordered writers produce output in index order")
+{
+  auto file = std::tmpfile();
+  REQUIRE(file);
+
+  {
+    auto out = ordered_writer(file);
+
+    out.write(2, "c");
+    out.write(1, "b");
+    REQUIRE(out.written() == 0);
+
+    out.write(0, "a");
+    REQUIRE(out.written() == 3);
+
+    auto queue = work_queue(4);
+    queue.run(97, [&] {
+      return [&](size_t i) { out.write(i + 3, std::to_string(i) + ","); };
+    });
+
+    REQUIRE(out.written() == 100);
+  }
+
+  auto expected = std::string("abc");
+  for (auto i = 0; i < 97; ++i) {
+    expected += std::to_string(i) + ",";
+  }
+
+  std::rewind(file);
+
+  auto actual = std::string(expected.size() + 1, '\0');
+  actual.resize(std::fread(actual.data(), 1, actual.size(), file));
+
+  REQUIRE(actual == expected);
+
+  std::fclose(file);
+}
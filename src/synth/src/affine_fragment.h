@@ -68,7 +68,7 @@ llvm::Value* affine_fragment::create_affine(Builder& b,
   std::copy_if(
       indices.begin(), indices.end(), std::back_inserter(i_shuf), is_int);
 
-  auto engine = support::get_random_engine();
+  auto& engine = support::thread_random_engine();
   std::shuffle(i_shuf.begin(), i_shuf.end(), engine);
   std::shuffle(c_shuf.begin(), c_shuf.end(), engine);
 
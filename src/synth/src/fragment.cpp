@@ -37,7 +37,7 @@ fragment::frag_ptr fragment::sample(
 
   // Then shuffle the indices to get the order in which we actually want to
   // sample them in.
-  std::shuffle(indices.begin(), indices.end(), get_random_engine());
+  std::shuffle(indices.begin(), indices.end(), thread_random_engine());
 
   // The solution starts with the first index
   auto solution = fragments[indices[0]];
@@ -17,7 +17,7 @@ namespace synth {
 
 generator::generator(property_set ps)
     : properties_(ps)
-    , random_(get_random_device()())
+    , random_(random_seed())
 {
 }
 
@@ -10,12 +10,19 @@ argument_generator generator_for(property_set ps)
   for (auto prop : ps.properties) {
     if (prop.name == "generator") {
       if (prop.values.at(0).is_string()) {
-        return generator_named(prop.values.at(0).string_val);
+        auto const& name = prop.values.at(0).string_val;
+
+        if (name == "uniform") {
+          return uniform_generator(ps);
+        }
+
+        return generator_named(name);
       }
     }
   }
 
-  return generator_named("uniform");
+  // Sized pointers can be allocated exactly when we have the property set.
+  return uniform_generator(ps);
 }
 
 argument_generator generator_named(std::string const& name)
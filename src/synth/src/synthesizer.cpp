@@ -24,36 +24,23 @@ namespace synth {
 synthesizer::synthesizer(props::property_set ps, call_wrapper& wrap)
     : properties_(ps)
     , reference_(wrap)
-    , examples_()
+    , examples_(wrap.get_builder().signature())
+    , tested_ {}
     , mod_("synth", thread_context::get())
 {
 }
 
 void synthesizer::make_examples(argument_generator gen, size_t n)
 {
-  for (auto i = 0u; i < n; ++i) {
-    auto cb = reference_.get_builder();
-    gen.gen_args(cb);
-    auto before = cb;
-    auto ret = reference_.call(cb);
-    examples_.push_back({before, {ret, cb}});
-  }
+  examples_.generate(reference_, gen, n);
 }
 
-bool synthesizer::satisfies_examples(Function* cand) const
+bool synthesizer::satisfies_examples(Function* cand)
 {
   auto wrap = call_wrapper {
       properties_.type_signature, *cand->getParent(), cand->getName()};
 
-  for (auto [in, out] : examples_) {
-    auto ret = wrap.call(in);
-
-    if (ret != out.return_value || in != out.output_args) {
-      return false;
-    }
-  }
-
-  return true;
+  return examples_.check(wrap);
 }
 
 generate_result synthesizer::debug_generate()
@@ -100,7 +87,7 @@ generate_result synthesizer::generate()
       return {attempts, nullptr};
     }
 
-    if (!satisfies_examples(cand)) {
+    if (!tested_.insert(*cand) || !satisfies_examples(cand)) {
       cand->eraseFromParent();
       cand = nullptr;
     }
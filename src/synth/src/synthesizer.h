@@ -2,6 +2,8 @@
 
 #include <support/argument_generator.h>
 #include <support/call_wrapper.h>
+#include <support/example_set.h>
+#include <support/fingerprint.h>
 
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
@@ -25,7 +27,7 @@ public:
 
 protected:
   void make_examples(support::argument_generator gen, size_t n);
-  bool satisfies_examples(llvm::Function* cand) const;
+  bool satisfies_examples(llvm::Function* cand);
 
   virtual llvm::Function* candidate() = 0;
 
@@ -34,10 +36,13 @@ protected:
   props::property_set properties_;
   support::call_wrapper& reference_;
 
-  std::vector<std::pair<support::call_builder, support::output_example>>
-      examples_;
+  support::example_set examples_;
   size_t attempts_ = 128;
 
+  // Fingerprints of the candidates tested so far, so that repeats of them can
+  // be skipped without being compiled and tested again.
+  support::fingerprint_cache tested_;
+
   llvm::Module mod_;
 
 private:
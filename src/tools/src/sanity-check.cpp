@@ -87,7 +87,7 @@ try {
 
       if (RunFunction) {
         auto ref = call_wrapper(ps.type_signature, mod, name, lib);
-        auto gen = uniform_generator();
+        auto gen = uniform_generator(ps);
 
         auto b = ref.get_builder();
         gen.gen_args(b);